@@ -0,0 +1,227 @@
+#include <rubr/debug/log.hpp>
+#include <rubr/fs/DirReader.hpp>
+#include <rubr/platform.h>
+
+#if RUBR_PLATFORM_OS_LINUX
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+namespace rubr::fs {
+
+    namespace {
+        bool is_dot_or_dotdot(const char *name)
+        {
+            return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+        }
+
+        Type to_type(const std::filesystem::file_status &status)
+        {
+            switch (status.type())
+            {
+                case std::filesystem::file_type::not_found:
+                case std::filesystem::file_type::none: return Type::Unknown;
+                case std::filesystem::file_type::regular: return Type::File;
+                case std::filesystem::file_type::directory: return Type::Directory;
+                default: break;
+            }
+            return Type::Other;
+        }
+
+#if RUBR_PLATFORM_OS_LINUX
+        // Layout as returned by the kernel, glibc does not expose this for getdents64()
+        struct Dirent64
+        {
+            std::uint64_t d_ino;
+            std::int64_t d_off;
+            unsigned short d_reclen;
+            unsigned char d_type;
+            char d_name[];
+        };
+
+        // Same size as the buffer glibc uses for readdir()
+        constexpr std::size_t c_buffer_size = 32 * 1024;
+
+        Type stat_type(int dir_fd, const char *name)
+        {
+            struct stat st;
+            if (::fstatat(dir_fd, name, &st, 0) != 0)
+                return Type::Unknown;
+            if (S_ISREG(st.st_mode))
+                return Type::File;
+            if (S_ISDIR(st.st_mode))
+                return Type::Directory;
+            return Type::Other;
+        }
+#endif
+    } // namespace
+
+    DirReader::DirReader(Backend backend)
+#if RUBR_PLATFORM_OS_LINUX
+        : backend_(backend)
+#else
+        : backend_(Backend::Std)
+#endif
+    {
+    }
+
+    DirReader::~DirReader()
+    {
+        close();
+    }
+
+    bool DirReader::open(const char *path)
+    {
+        S(nullptr);
+        L(C(path));
+
+        close();
+
+        switch (backend_)
+        {
+            case Backend::Std:
+            {
+                std::error_code ec;
+                path_ = path;
+                it_ = std::filesystem::directory_iterator(path_, ec);
+                return !ec;
+            }
+            case Backend::Getdents:
+#if RUBR_PLATFORM_OS_LINUX
+                fd_ = ::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                return fd_ >= 0;
+#else
+                break;
+#endif
+        }
+        return false;
+    }
+
+    bool DirReader::open(const DirReader &parent, const char *name, const char *path)
+    {
+#if RUBR_PLATFORM_OS_LINUX
+        if (backend_ == Backend::Getdents && parent.fd_ >= 0)
+        {
+            close();
+            // Resolving a single path component relative to the parent is cheaper than resolving the full path
+            fd_ = ::openat(parent.fd_, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            return fd_ >= 0;
+        }
+#endif
+        return open(path);
+    }
+
+    void DirReader::close()
+    {
+        it_ = {};
+#if RUBR_PLATFORM_OS_LINUX
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+#endif
+        pos_ = 0;
+        size_ = 0;
+        error_ = false;
+    }
+
+    bool DirReader::next(Entry &entry)
+    {
+        S(nullptr);
+
+        switch (backend_)
+        {
+            case Backend::Std:
+            {
+                if (it_ == std::filesystem::directory_iterator())
+                    return false;
+
+                std::error_code ec;
+                const auto &dir_entry = *it_;
+                name_ = dir_entry.path().filename().native();
+                entry.name = name_;
+                if (dir_entry.is_regular_file(ec))
+                    entry.type = Type::File;
+                else if (dir_entry.is_directory(ec))
+                    entry.type = Type::Directory;
+                else
+                    entry.type = Type::Other;
+
+                it_.increment(ec);
+                if (ec)
+                {
+                    // Reported by the next call
+                    L("Could not read " << path_ << ": " << ec.message());
+                    error_ = true;
+                    it_ = {};
+                }
+                return true;
+            }
+            case Backend::Getdents:
+#if RUBR_PLATFORM_OS_LINUX
+                if (fd_ < 0)
+                    return false;
+                if (!buffer_)
+                    buffer_.reset(new char[c_buffer_size]);
+                while (true)
+                {
+                    if (pos_ >= size_)
+                    {
+                        const auto nr = ::syscall(SYS_getdents64, fd_, buffer_.get(), c_buffer_size);
+                        if (nr < 0)
+                        {
+                            L("getdents64() failed " << C(errno));
+                            error_ = true;
+                            return false;
+                        }
+                        if (nr == 0)
+                            // End of folder
+                            return false;
+                        pos_ = 0;
+                        size_ = nr;
+                    }
+
+                    const auto *dirent = (const Dirent64 *)(buffer_.get() + pos_);
+                    pos_ += dirent->d_reclen;
+
+                    if (is_dot_or_dotdot(dirent->d_name))
+                        continue;
+
+                    entry.name = dirent->d_name;
+                    switch (dirent->d_type)
+                    {
+                        case DT_REG: entry.type = Type::File; break;
+                        case DT_DIR: entry.type = Type::Directory; break;
+                        // Not all filesystems fill in d_type, and symlinks are resolved to keep parity with the Std backend
+                        case DT_UNKNOWN:
+                        case DT_LNK: entry.type = stat_type(fd_, dirent->d_name); break;
+                        default: entry.type = Type::Other; break;
+                    }
+                    return true;
+                }
+#else
+                break;
+#endif
+        }
+        return false;
+    }
+
+    Type DirReader::type(const char *name) const
+    {
+#if RUBR_PLATFORM_OS_LINUX
+        if (backend_ == Backend::Getdents && fd_ >= 0)
+            return stat_type(fd_, name);
+#endif
+        std::error_code ec;
+        return to_type(std::filesystem::status(path_ / name, ec));
+    }
+
+} // namespace rubr::fs
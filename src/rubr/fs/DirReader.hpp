@@ -0,0 +1,80 @@
+#ifndef HEADER_rubr_fs_DirReader_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_fs_DirReader_hpp_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace rubr::fs {
+
+    enum class Backend
+    {
+        // Portable, based on std::filesystem::directory_iterator
+        Std,
+        // Linux only: bulk getdents64() on openat()-relative fds. Falls back to Std on other platforms.
+        Getdents,
+    };
+
+    enum class Type
+    {
+        Unknown,
+        File,
+        Directory,
+        Other,
+    };
+
+    // Enumerates the entries of a single directory, skipping '.' and '..'.
+    // Symlinks are followed, as std::filesystem::directory_entry::is_regular_file() and is_directory() do.
+    class DirReader
+    {
+    public:
+        struct Entry
+        {
+            // Points into the reader and is always followed by a '\0'. Only valid until the next call to next().
+            std::string_view name;
+            Type type = Type::Unknown;
+        };
+
+        DirReader(Backend backend = Backend::Std);
+        ~DirReader();
+
+        DirReader(const DirReader &) = delete;
+        DirReader &operator=(const DirReader &) = delete;
+
+        Backend backend() const { return backend_; }
+
+        bool open(const char *path);
+        // Opens the subfolder `name` of `parent`, which must still be open.
+        // `path` is the full path of this subfolder and is used by the Std backend.
+        bool open(const DirReader &parent, const char *name, const char *path);
+        void close();
+
+        // Returns false when there are no more entries, or when the folder could not be read further
+        bool next(Entry &entry);
+        // True when next() returned false because reading the folder failed: its entries are incomplete
+        bool error() const { return error_; }
+
+        // Type of the entry `name` in this folder, following symlinks. Returns Type::Unknown when it does not exist.
+        Type type(const char *name) const;
+
+    private:
+        Backend backend_;
+        bool error_ = false;
+
+        // Std backend
+        std::filesystem::directory_iterator it_;
+        std::filesystem::path path_;
+        std::string name_;
+
+        // Getdents backend
+        int fd_ = -1;
+        std::unique_ptr<char[]> buffer_;
+        std::size_t pos_ = 0;
+        std::size_t size_ = 0;
+    };
+
+} // namespace rubr::fs
+
+#endif
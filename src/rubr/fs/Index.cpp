@@ -0,0 +1,181 @@
+#include <rubr/fs/Index.hpp>
+#include <rubr/mss.hpp>
+#include <rubr/platform.h>
+#include <rubr/strng/append.hpp>
+
+#if RUBR_PLATFORM_API_POSIX
+    #include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace rubr::fs {
+
+    namespace {
+        // Bump the version when the format changes
+        constexpr std::string_view c_magic = "rubrIX03";
+        constexpr std::size_t c_header_size = c_magic.size() + sizeof(std::uint64_t);
+    } // namespace
+
+    bool Index::stat(Stat &stat, const char *path)
+    {
+#if RUBR_PLATFORM_API_POSIX
+        struct stat st;
+        if (::stat(path, &st) != 0)
+            return false;
+        stat.key.dev = st.st_dev;
+        stat.key.ino = st.st_ino;
+        stat.size = st.st_size;
+        stat.mtime_ns = (std::uint64_t)st.st_mtim.tv_sec * 1'000'000'000ull + st.st_mtim.tv_nsec;
+        stat.ctime_ns = (std::uint64_t)st.st_ctim.tv_sec * 1'000'000'000ull + st.st_ctim.tv_nsec;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void Index::Folder::clear()
+    {
+        has_ignore_ = false;
+        ignore_ = {};
+        children_ = {};
+        ignore_buffer_.clear();
+        children_buffer_.clear();
+    }
+
+    void Index::Folder::set_ignore(std::string_view ignore)
+    {
+        has_ignore_ = true;
+        ignore_buffer_ = ignore;
+        ignore_ = ignore_buffer_;
+    }
+
+    void Index::Folder::add_child(std::string_view name, Type type)
+    {
+        strng::append_lsb(children_buffer_, (std::uint8_t)type);
+        strng::append_sized<std::uint16_t>(children_buffer_, name);
+        children_buffer_.push_back('\0');
+        children_ = children_buffer_;
+    }
+
+    bool Index::load(const std::filesystem::path &fp)
+    {
+        MSS_BEGIN(bool);
+
+        file_.close();
+        slots_ = nullptr;
+        slot_count_ = 0;
+
+        if (!file_.open(fp))
+            // No index yet
+            MSS_RETURN_OK();
+
+        const auto content = file_.content();
+        rubr::parse::Strange strange{content.data(), content.size()};
+        std::uint64_t slot_count;
+        if (!strange.pop_if(std::string{c_magic}) || !strange.pop_lsb(slot_count) || slot_count > (content.size() - c_header_size) / sizeof(Slot))
+        {
+            L("Ignoring invalid index " << fp);
+            file_.close();
+            MSS_RETURN_OK();
+        }
+
+        // mmap() returns page-aligned memory and c_header_size is a multiple of 8
+        slots_ = (const Slot *)(content.data() + c_header_size);
+        slot_count_ = slot_count;
+
+        MSS_END();
+    }
+
+    bool Index::find(Folder &folder, const Key &key, std::uint64_t check) const
+    {
+        MSS_BEGIN(bool);
+
+        const auto end = slots_ + slot_count_;
+        const auto it = std::lower_bound(slots_, end, key, [](const Slot &slot, const Key &key) {
+            return Key{slot.dev, slot.ino} < key;
+        });
+        MSS_Q(it != end);
+        const Key it_key{it->dev, it->ino};
+        MSS_Q(it_key == key);
+
+        const auto content = file_.content();
+        MSS_Q(it->offset <= content.size() && it->size <= content.size() - it->offset);
+        const char *data = content.data() + it->offset;
+        rubr::parse::Strange strange{data, it->size};
+        // Returns a view on the next nr bytes from strange, pointing into the mapped file
+        auto pop_view = [&](std::string_view &view, std::size_t nr) {
+            const auto ix = it->size - strange.size();
+            if (!strange.pop_count(nr))
+                return false;
+            view = std::string_view{data + ix, nr};
+            return true;
+        };
+
+        std::uint64_t entry_check;
+        MSS_Q(strange.pop_lsb(entry_check));
+        MSS_Q(entry_check == check);
+
+        folder.clear();
+
+        std::uint8_t has_ignore;
+        std::uint32_t size;
+        MSS_Q(strange.pop_lsb(has_ignore));
+        folder.has_ignore_ = !!has_ignore;
+        MSS_Q(strange.pop_lsb(size));
+        MSS_Q(pop_view(folder.ignore_, size));
+        MSS_Q(strange.pop_lsb(size));
+        MSS_Q(pop_view(folder.children_, size));
+
+        MSS_END();
+    }
+
+    void Index::add(const Key &key, std::uint64_t check, const Folder &folder)
+    {
+        std::string entry;
+        entry.reserve(sizeof(check) + 1 + 4 + folder.ignore_.size() + 4 + folder.children_.size());
+        strng::append_lsb(entry, check);
+        strng::append_lsb(entry, (std::uint8_t)folder.has_ignore_);
+        strng::append_sized<std::uint32_t>(entry, folder.ignore_);
+        strng::append_sized<std::uint32_t>(entry, folder.children_);
+
+        std::lock_guard<std::mutex> lock{mutex_};
+        added_[key] = std::move(entry);
+    }
+
+    bool Index::save(const std::filesystem::path &fp) const
+    {
+        MSS_BEGIN(bool);
+
+        std::string content{c_magic};
+        strng::append_lsb(content, (std::uint64_t)added_.size());
+
+        std::uint64_t offset = c_header_size + added_.size() * sizeof(Slot);
+        for (const auto &[key, entry] : added_)
+        {
+            const Slot slot{.dev = key.dev, .ino = key.ino, .offset = offset, .size = entry.size()};
+            content.append((const char *)&slot, sizeof(slot));
+            offset += entry.size();
+        }
+        for (const auto &[key, entry] : added_)
+            content += entry;
+
+        auto tmp_fp = fp;
+        tmp_fp += ".tmp";
+        {
+            std::ofstream fo{tmp_fp, std::ios::binary | std::ios::trunc};
+            MSS(fo.good());
+            fo.write(content.data(), content.size());
+            MSS(fo.good());
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmp_fp, fp, ec);
+        MSS(!ec);
+
+        MSS_END();
+    }
+
+} // namespace rubr::fs
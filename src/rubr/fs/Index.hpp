@@ -0,0 +1,147 @@
+#ifndef HEADER_rubr_fs_Index_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_fs_Index_hpp_ALREADY_INCLUDED
+
+#include <rubr/fs/DirReader.hpp>
+#include <rubr/fs/MappedFile.hpp>
+#include <rubr/parse/Strange.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace rubr::fs {
+
+    // Persistent, memory-mapped index of folder content, as used by fs::Walker to replay folders that did not change.
+    // Folders are keyed by their device and inode, and an entry is only used when its check value matches:
+    // the caller is responsible to fold everything that influences the content into this value.
+    class Index
+    {
+    public:
+        struct Key
+        {
+            std::uint64_t dev = 0;
+            std::uint64_t ino = 0;
+
+            auto operator<=>(const Key &) const = default;
+        };
+
+        // Subset of stat() that is relevant for change detection
+        struct Stat
+        {
+            Key key;
+            std::uint64_t size = 0;
+            std::uint64_t mtime_ns = 0;
+            std::uint64_t ctime_ns = 0;
+        };
+        // Returns false when path does not exist or stat() is not supported
+        static bool stat(Stat &stat, const char *path);
+
+        // Content of a single folder
+        class Folder
+        {
+        public:
+            void clear();
+
+            void set_ignore(std::string_view ignore);
+            void add_child(std::string_view name, Type type);
+
+            // Serialized glob::Ignore of the '.gitignore' in this folder, if any
+            bool has_ignore() const { return has_ignore_; }
+            std::string_view ignore() const { return ignore_; }
+
+            // Serialized children, to be iterated with pop_child()
+            std::string_view children() const { return children_; }
+            // Pops the next child from children, which must not be empty. name is always followed by a '\0'.
+            static bool pop_child(std::string_view &children, std::string_view &name, Type &type)
+            {
+                rubr::parse::Strange strange{children.data(), children.size()};
+                std::uint8_t t;
+                std::uint16_t size;
+                if (!strange.pop_lsb(t) || !strange.pop_lsb(size) || size == 0)
+                    return false;
+                name = children.substr(children.size() - strange.size(), size);
+                if (!strange.pop_count(size) || !strange.pop_if('\0'))
+                    return false;
+                type = (Type)t;
+                children.remove_prefix(children.size() - strange.size());
+                return true;
+            }
+
+            // Calls ftor(std::string_view name, Type type) for each child. name is always followed by a '\0'.
+            template<typename Ftor>
+            bool each_child(Ftor &&ftor) const
+            {
+                std::string_view name;
+                Type type;
+                for (auto children = children_; !children.empty();)
+                {
+                    if (!pop_child(children, name, type))
+                        return false;
+                    ftor(name, type);
+                }
+                return true;
+            }
+
+        private:
+            friend class Index;
+
+            bool has_ignore_ = false;
+            std::string_view ignore_;
+            std::string_view children_;
+
+            // Only used while building
+            std::string ignore_buffer_;
+            std::string children_buffer_;
+        };
+
+        // Maps an existing index file. A missing or invalid file results in an empty index.
+        bool load(const std::filesystem::path &fp);
+
+        // Returns true when the loaded index has an entry for key with the given check value.
+        // folder points into the mapped file and stays valid until the next load().
+        bool find(Folder &folder, const Key &key, std::uint64_t check) const;
+
+        // Adds an entry to be written by save(). Can be called concurrently.
+        void add(const Key &key, std::uint64_t check, const Folder &folder);
+
+        // Writes all added entries, replacing the file atomically
+        bool save(const std::filesystem::path &fp) const;
+
+    private:
+        struct Slot
+        {
+            std::uint64_t dev;
+            std::uint64_t ino;
+            std::uint64_t offset;
+            std::uint64_t size;
+        };
+
+        MappedFile file_;
+        const Slot *slots_ = nullptr;
+        std::size_t slot_count_ = 0;
+
+        std::mutex mutex_;
+        std::map<Key, std::string> added_;
+    };
+
+    // FNV-1a, stable across runs which is required for values that are persisted
+    inline std::uint64_t hash(std::string_view sv, std::uint64_t h = 0xcbf29ce484222325ull)
+    {
+        for (const auto ch : sv)
+        {
+            h ^= (std::uint8_t)ch;
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+    inline std::uint64_t hash(std::uint64_t v, std::uint64_t h = 0xcbf29ce484222325ull)
+    {
+        return hash(std::string_view{(const char *)&v, sizeof(v)}, h);
+    }
+
+} // namespace rubr::fs
+
+#endif
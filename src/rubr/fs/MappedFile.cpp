@@ -0,0 +1,65 @@
+#include <rubr/fs/MappedFile.hpp>
+#include <rubr/fs/util.hpp>
+#include <rubr/mss.hpp>
+#include <rubr/platform.h>
+
+#if RUBR_PLATFORM_API_POSIX
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace rubr::fs {
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool MappedFile::open(const std::filesystem::path &fp)
+    {
+        MSS_BEGIN(bool);
+
+        close();
+
+#if RUBR_PLATFORM_API_POSIX
+        const int fd = ::open(fp.c_str(), O_RDONLY | O_CLOEXEC);
+        MSS_Q(fd >= 0);
+
+        struct stat st;
+        MSS(::fstat(fd, &st) == 0, ::close(fd));
+
+        if (st.st_size > 0)
+        {
+            void *ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            MSS(ptr != MAP_FAILED, ::close(fd));
+            data_ = (const char *)ptr;
+            size_ = st.st_size;
+        }
+        // The mapping stays valid after closing the fd
+        ::close(fd);
+#else
+        MSS_Q(rubr::fs::read(buffer_, fp));
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+#endif
+
+        is_open_ = true;
+
+        MSS_END();
+    }
+
+    void MappedFile::close()
+    {
+#if RUBR_PLATFORM_API_POSIX
+        if (data_)
+            ::munmap((void *)data_, size_);
+#endif
+        buffer_.clear();
+        data_ = nullptr;
+        size_ = 0;
+        is_open_ = false;
+    }
+
+} // namespace rubr::fs
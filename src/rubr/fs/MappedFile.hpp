@@ -0,0 +1,37 @@
+#ifndef HEADER_rubr_fs_MappedFile_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_fs_MappedFile_hpp_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace rubr::fs {
+
+    // Read-only memory-mapped file. Falls back to reading the file into memory when mmap() is not available.
+    class MappedFile
+    {
+    public:
+        MappedFile() {}
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool open(const std::filesystem::path &fp);
+        void close();
+
+        bool is_open() const { return is_open_; }
+        std::string_view content() const { return std::string_view{data_, size_}; }
+
+    private:
+        bool is_open_ = false;
+        const char *data_ = nullptr;
+        std::size_t size_ = 0;
+        // Only used when mmap() is not available
+        std::string buffer_;
+    };
+
+} // namespace rubr::fs
+
+#endif
@@ -0,0 +1,296 @@
+#include <rubr/fs/Walker.hpp>
+
+#include <algorithm>
+
+namespace rubr::fs {
+
+    namespace {
+        std::string normalize(const std::filesystem::path &dir)
+        {
+            std::string str = dir.native();
+            while (str.size() > 1 && str.ends_with('/'))
+                str.pop_back();
+            return str;
+        }
+
+        // Large enough for any path the OS accepts
+        constexpr std::size_t c_path_capacity = 4096;
+    } // namespace
+
+    Walker::Walker(const Config &config)
+        : config_(config), basedir_(normalize(config.basedir)), base_(name_offset_(basedir_))
+    {
+    }
+
+    unsigned int Walker::thread_count_() const
+    {
+        if (config_.thread_count == 0)
+            return std::max(std::thread::hardware_concurrency(), 1u);
+        return config_.thread_count;
+    }
+
+    void Walker::init_path_(std::string &path) const
+    {
+        path.reserve(c_path_capacity);
+        path = basedir_;
+    }
+
+    bool Walker::enter_(IgnoreLevelPtr &level, const std::string &dir, const DirReader &reader, Index::Folder *folder) const
+    {
+        MSS_BEGIN(bool);
+
+        for (const auto &filename : {".gitignore"})
+        {
+            if (reader.type(filename) == Type::File)
+            {
+                const auto fp = std::filesystem::path{dir} / filename;
+                L("Found ignore file " << fp);
+                auto new_level = std::make_shared<IgnoreLevel>();
+                new_level->parent = level;
+                new_level->base = name_offset_(dir);
+                if (ignore_cache_)
+                {
+                    MSS(ignore_cache_->load_ignore(new_level->ignore, fp));
+                }
+                else
+                {
+                    MSS(new_level->ignore.load_from_file(fp));
+                }
+                new_level->stack = level ? level->stack : rubr::glob::IgnoreStack{};
+                new_level->stack.push(new_level->ignore, new_level->base);
+                if (folder)
+                {
+                    std::string rules;
+                    new_level->ignore.write(rules);
+                    new_level->fingerprint = hash(rules, hash(new_level->base, level ? level->fingerprint : 0));
+                    folder->set_ignore(rules);
+                }
+                level = std::move(new_level);
+                break;
+            }
+        }
+
+        // Add a dummy ignore, if needed.
+        if (!level)
+        {
+            auto new_level = std::make_shared<IgnoreLevel>();
+            new_level->base = name_offset_(dir);
+            level = std::move(new_level);
+        }
+
+        MSS_END();
+    }
+
+    bool Walker::lookup_(bool &found, Index::Folder &folder, Index::Key &key, std::uint64_t &check, std::string &dir, IgnoreLevelPtr &level) const
+    {
+        MSS_BEGIN(bool);
+
+        found = false;
+        check = 0;
+
+        Index::Stat dir_stat;
+        if (!Index::stat(dir_stat, dir.c_str()))
+            // We cannot index this folder, the caller will report the error when opening it
+            MSS_RETURN_OK();
+        key = dir_stat.key;
+
+        // Changes to a '.gitignore' do not necessarily change the mtime of its folder
+        Index::Stat ignore_stat;
+        const auto dir_size = dir.size();
+        dir += "/.gitignore";
+        const bool has_ignore = Index::stat(ignore_stat, dir.c_str());
+        dir.resize(dir_size);
+
+        // The content of a folder also depends on its location and the rules of its parents
+        check = hash(dir, hash(level ? level->fingerprint : 0, hash(config_.include_hidden)));
+        for (const auto v : {dir_stat.mtime_ns, dir_stat.ctime_ns})
+            check = hash(v, check);
+        if (has_ignore)
+        {
+            for (const auto v : {ignore_stat.key.ino, ignore_stat.size, ignore_stat.mtime_ns, ignore_stat.ctime_ns})
+                check = hash(v, check);
+        }
+        // 0 is reserved for folders that cannot be indexed
+        check = std::max<std::uint64_t>(check, 1);
+
+        if (!index_->find(folder, key, check))
+            MSS_RETURN_OK();
+
+        if (folder.has_ignore())
+        {
+            auto new_level = std::make_shared<IgnoreLevel>();
+            new_level->parent = level;
+            new_level->base = name_offset_(dir);
+            rubr::parse::Strange strange{folder.ignore().data(), folder.ignore().size()};
+            if (!new_level->ignore.read(strange))
+            {
+                L("Could not read ignore rules from index for " << dir);
+                MSS_RETURN_OK();
+            }
+            new_level->stack = level ? level->stack : rubr::glob::IgnoreStack{};
+            new_level->stack.push(new_level->ignore, new_level->base);
+            new_level->fingerprint = hash(folder.ignore(), hash(new_level->base, level ? level->fingerprint : 0));
+            level = std::move(new_level);
+        }
+        else if (!level)
+        {
+            auto new_level = std::make_shared<IgnoreLevel>();
+            new_level->base = name_offset_(dir);
+            level = std::move(new_level);
+        }
+
+        found = true;
+
+        MSS_END();
+    }
+
+    bool Walker::open_frame_(Frame &frame, std::string &path, const DirReader *parent, IgnoreLevelPtr level, rubr::glob::Below below) const
+    {
+        MSS_BEGIN(bool);
+
+        L(C(path));
+
+        frame.dir_size = path.size();
+        frame.offsets = Offsets{.base = base_, .name = name_offset_(path)};
+        frame.check = 0;
+        frame.replay = false;
+        frame.children = {};
+        frame.valid = true;
+        frame.match = true;
+
+        if (index_)
+        {
+            bool found = false;
+            MSS(lookup_(found, frame.folder, frame.key, frame.check, path, level));
+            if (found)
+            {
+                L("Replaying " << path << " from index");
+                ++replay_count_;
+                index_->add(frame.key, frame.check, frame.folder);
+                frame.replay = true;
+                frame.children = frame.folder.children();
+                frame.level = std::move(level);
+                MSS_RETURN_OK();
+            }
+        }
+        // A failed lookup might have left partial content
+        frame.folder.clear();
+
+        if (parent)
+        {
+            MSS(frame.reader.open(*parent, path.c_str() + path.rfind('/') + 1, path.c_str()));
+        }
+        else
+        {
+            MSS(frame.reader.open(path.c_str()));
+        }
+
+        const auto *outer = level.get();
+        MSS(enter_(level, path, frame.reader, frame.check ? &frame.folder : nullptr));
+        if (level.get() != outer)
+            // The rules of this folder itself were added
+            below = level->stack.below(path);
+        frame.match = below != rubr::glob::Below::None;
+        L(C(frame.match));
+        frame.level = std::move(level);
+
+        MSS_END();
+    }
+
+    std::optional<rubr::glob::DecisionCache> Walker::decision_cache_() const
+    {
+        if (config_.decision_cache_capacity == 0)
+            return std::nullopt;
+        return rubr::glob::DecisionCache{config_.decision_cache_capacity};
+    }
+
+    bool Walker::next_entry_(Frame &frame, std::string &path, Type &type, rubr::glob::DecisionCache *cache) const
+    {
+        S(nullptr);
+
+        auto set_path = [&](std::string_view name) {
+            path.resize(frame.dir_size);
+            if (frame.offsets.name > frame.dir_size)
+                path += '/';
+            path += name;
+        };
+
+        if (frame.replay)
+        {
+            for (std::string_view name; !frame.children.empty();)
+            {
+                if (!Index::Folder::pop_child(frame.children, name, type))
+                {
+                    L("Corrupt index entry for " << path.substr(0, frame.dir_size));
+                    frame.valid = false;
+                    return false;
+                }
+                if (type == Type::File || type == Type::Directory)
+                {
+                    set_path(name);
+                    frame.below = rubr::glob::Below::Some;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const auto &stack = frame.level->stack;
+        for (DirReader::Entry entry; frame.reader.next(entry);)
+        {
+            if (entry.type != Type::File && entry.type != Type::Directory)
+                continue;
+
+            set_path(entry.name);
+
+            L(C(path));
+
+            if (!config_.include_hidden && entry.name[0] == '.')
+            {
+                L("Skipping hidden path " << path);
+                continue;
+            }
+
+            frame.below = rubr::glob::Below::None;
+            if (frame.match)
+            {
+                if (stack(path, path.size() - entry.name.size(), cache))
+                {
+                    L("Skipping ignored path " << path);
+                    continue;
+                }
+                if (entry.type == Type::Directory)
+                {
+                    frame.below = stack.below(path);
+                    if (frame.below == rubr::glob::Below::All)
+                    {
+                        L("Skipping folder with only ignored paths " << path);
+                        continue;
+                    }
+                }
+            }
+
+            if (frame.check)
+                frame.folder.add_child(entry.name, entry.type);
+
+            type = entry.type;
+            return true;
+        }
+        if (frame.reader.error())
+        {
+            // A partial listing must neither be reported as success nor end up in index_
+            L("Could not read all entries of " << path.substr(0, frame.dir_size));
+            frame.valid = false;
+        }
+        return false;
+    }
+
+    void Walker::close_frame_(Frame &frame, std::string &path) const
+    {
+        path.resize(frame.dir_size);
+        if (frame.check && !frame.replay)
+            index_->add(frame.key, frame.check, frame.folder);
+        frame.reader.close();
+    }
+
+} // namespace rubr::fs
@@ -1,11 +1,27 @@
 #ifndef HEADER_rubr_fs_Walker_hpp_ALREADY_INCLUDED
 #define HEADER_rubr_fs_Walker_hpp_ALREADY_INCLUDED
 
+#include <rubr/fs/DirReader.hpp>
+#include <rubr/fs/Index.hpp>
 #include <rubr/fs/util.hpp>
+#include <rubr/glob/DecisionCache.hpp>
 #include <rubr/glob/Ignore.hpp>
+#include <rubr/glob/IgnoreCache.hpp>
+#include <rubr/glob/IgnoreStack.hpp>
 #include <rubr/mss.hpp>
+#include <rubr/thread/WorkQueue.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -20,101 +36,387 @@ namespace rubr::fs {
         {
             std::filesystem::path basedir;
             bool include_hidden = false;
+            Backend backend = Backend::Std;
+            // When larger than 1, subfolders are distributed over a work-stealing pool of this many threads
+            // and ftor is called concurrently from all of them. Use 0 for std::thread::hardware_concurrency().
+            unsigned int thread_count = 1;
+            // When set, folders that did not change since the previous walk are replayed from this index file
+            // instead of being read and matched again. The index is updated after each successful walk.
+            std::filesystem::path index;
+            // When set, the compiled rules of '.gitignore' files that did not change since the previous walk are
+            // loaded from this cache file instead of being parsed again. The cache is updated after each successful walk.
+            std::filesystem::path ignore_cache;
+            // When not 0, each thread memoizes the decisions of '.gitignore' files with only name-based rules
+            // in a glob::DecisionCache of this capacity. Pays off for trees with many files of the same name.
+            std::size_t decision_cache_capacity = 0;
         };
 
-        Walker(const Config &config)
-            : config_(config) {}
+        // Offsets into the path passed to ftor
+        struct Offsets
+        {
+            // Start of the path relative to Config.basedir
+            std::size_t base = 0;
+            // Start of the filename
+            std::size_t name = 0;
+        };
+
+        enum class Kind
+        {
+            // A folder is about to be walked. Return Result::Skip to prune it.
+            Enter,
+            // All entries of a folder were walked
+            Leave,
+            File,
+        };
 
-        template<typename Ftor, typename ReturnCode = std::invoke_result_t<Ftor, const std::filesystem::path &>>
+        // Return code for an ftor that receives a Kind. Compatible with the MSS macros.
+        enum class Result
+        {
+            Ok,
+            Skip,
+            Error,
+        };
+
+    private:
+        template<typename Ftor>
+        static auto file_ftor_(Ftor &&ftor, const std::string &path, const Offsets &offsets)
+        {
+            if constexpr (std::is_invocable_v<Ftor, std::string_view, const Offsets &>)
+                return ftor(std::string_view{path}, offsets);
+            else
+                return ftor(std::filesystem::path{path});
+        }
+
+        template<typename Ftor>
+        struct ReturnCode_
+        {
+            using Type = decltype(file_ftor_(std::declval<Ftor &>(), std::declval<const std::string &>(), std::declval<const Offsets &>()));
+        };
+        template<typename Ftor>
+            requires std::is_invocable_v<Ftor, std::string_view, const Offsets &, Kind>
+        struct ReturnCode_<Ftor>
+        {
+            using Type = std::invoke_result_t<Ftor &, std::string_view, const Offsets &, Kind>;
+        };
+
+    public:
+        template<typename Ftor>
+        using ReturnCode_t = typename ReturnCode_<Ftor>::Type;
+
+        Walker(const Config &config);
+
+        // ftor can take either:
+        // - (std::string_view path, const Offsets &offsets, Kind kind): called for each file and folder.
+        //   When ftor returns Result, Skip can be used to prune a folder on Enter.
+        //   For the toplevel Enter and Leave, path is Config.basedir and Offsets.base is its size.
+        // - (std::string_view path, const Offsets &offsets): only called for files.
+        // - (const std::filesystem::path &path): only called for files.
+        // The string_view variants point into a reused buffer and are only valid during the call.
+        // Together with Backend::Getdents, this results in a walk without any per-entry allocation.
+        // Folders are walked with an explicit stack: the depth of the tree does not influence the C++ stack.
+        template<typename Ftor, typename ReturnCode = ReturnCode_t<Ftor>>
         ReturnCode operator()(Ftor &&ftor)
         {
             MSS_BEGIN(ReturnCode, "");
-            MSS(call_(config_.basedir, ftor));
+            replay_count_ = 0;
+            ignore_cache_.reset();
+            if (!config_.index.empty())
+            {
+                index_ = std::make_unique<Index>();
+                MSS(index_->load(config_.index));
+            }
+            if (!config_.ignore_cache.empty())
+            {
+                ignore_cache_ = std::make_unique<rubr::glob::IgnoreCache>();
+                MSS(ignore_cache_->load(config_.ignore_cache));
+            }
+            if (thread_count_() > 1)
+            {
+                MSS(call_parallel_(ftor));
+            }
+            else
+            {
+                std::string path;
+                init_path_(path);
+                MSS(call_(path, nullptr, ftor, no_enter_));
+            }
+            if (index_)
+                MSS(index_->save(config_.index));
+            if (ignore_cache_)
+                MSS(ignore_cache_->save(config_.ignore_cache));
             MSS_END();
         }
 
+        // Number of folders of the last walk that were replayed from Config.index
+        std::size_t replay_count() const { return replay_count_; }
+        // Number of '.gitignore' files of the last walk that were loaded from Config.ignore_cache
+        std::size_t ignore_cache_hit_count() const { return ignore_cache_ ? ignore_cache_->hit_count() : 0; }
+
     private:
-        template<typename Ftor, typename ReturnCode = std::invoke_result_t<Ftor, const std::filesystem::path &>>
-        ReturnCode call_(const std::filesystem::path &dir, Ftor &&ftor)
+        friend class Watcher;
+
+        // Immutable once created, which allows sharing it between threads
+        struct IgnoreLevel
         {
-            MSS_BEGIN(ReturnCode);
+            std::shared_ptr<const IgnoreLevel> parent;
+            rubr::glob::Ignore ignore;
+            // Start of the path relative to the folder of this level
+            std::size_t base = 0;
+            // Rules of this level and all its parents, which is what decides the entries below this level
+            rubr::glob::IgnoreStack stack;
+            // Identifies the rules of this level and its parents, only set when an index is used
+            std::uint64_t fingerprint = 0;
+        };
+        using IgnoreLevelPtr = std::shared_ptr<const IgnoreLevel>;
 
-            L(C(dir));
+        struct Task
+        {
+            std::string dir;
+            IgnoreLevelPtr level;
+            // Offsets of dir itself
+            Offsets offsets;
+            rubr::glob::Below below = rubr::glob::Below::Some;
+        };
 
-            bool added_ignore = false;
+        // State of a single folder that is being walked. Frames are reused to avoid reallocating their buffers.
+        struct Frame
+        {
+            Frame(Backend backend)
+                : reader(backend) {}
 
-            for (const auto &filename : {".gitignore"})
-            {
-                static std::filesystem::path fp;
-                fp = dir;
-                fp /= filename;
+            DirReader reader;
+            IgnoreLevelPtr level;
+            std::size_t dir_size = 0;
+            // Offsets of the entries of this folder
+            Offsets offsets;
+            // Cleared when no ignore rule can match below this folder
+            bool match = true;
+            // Analysis of the last folder returned by next_entry_()
+            rubr::glob::Below below = rubr::glob::Below::Some;
+
+            Index::Folder folder;
+            Index::Key key;
+            // Only set when this folder is added to index_
+            std::uint64_t check = 0;
+            // When replaying from index_, the remaining children are popped from children and reader is not used
+            bool replay = false;
+            std::string_view children;
+            // Set to false when the children from index_ are corrupt, or when reader failed
+            bool valid = true;
+        };
+
+        unsigned int thread_count_() const;
+
+        // Sets path to the normalized Config.basedir, with enough capacity to avoid reallocations during the walk
+        void init_path_(std::string &path) const;
+        // Offset where the name of an entry in dir starts
+        static std::size_t name_offset_(const std::string &dir)
+        {
+            return dir.size() + (dir.ends_with('/') ? 0 : 1);
+        }
+
+        // Replaces level with a new IgnoreLevel when dir contains a '.gitignore'.
+        // When folder is given, the parsed rules are stored in it as well.
+        bool enter_(IgnoreLevelPtr &level, const std::string &dir, const DirReader &reader, Index::Folder *folder) const;
+
+        // Looks up dir in index_. When found, level is updated with the rules from the index.
+        // check is set to the value that must be used when adding dir to index_, or to 0 when dir cannot be indexed.
+        bool lookup_(bool &found, Index::Folder &folder, Index::Key &key, std::uint64_t &check, std::string &dir, IgnoreLevelPtr &level) const;
 
-                if (std::filesystem::is_regular_file(fp))
+        // Prepares frame to walk the folder in path, either from index_ or via its reader.
+        // The reader is opened relative to parent, if given. below is the analysis of path with level.
+        bool open_frame_(Frame &frame, std::string &path, const DirReader *parent, IgnoreLevelPtr level, rubr::glob::Below below) const;
+        // Sets path to the next entry of frame that is a file or folder and that is not hidden or ignored.
+        // Folders for which all entries would be ignored are skipped as well.
+        // Returns false when there are no more entries, or when they could not be read: frame.valid is cleared then.
+        bool next_entry_(Frame &frame, std::string &path, Type &type, rubr::glob::DecisionCache *cache) const;
+        // Only created when Config.decision_cache_capacity is set
+        std::optional<rubr::glob::DecisionCache> decision_cache_() const;
+        // Restores path to the folder of frame and adds it to index_, if needed
+        void close_frame_(Frame &frame, std::string &path) const;
+
+        static bool no_enter_(const std::string &, const IgnoreLevelPtr &) { return true; }
+
+        // Calls ftor with the given kind, mapping Result::Skip to Ok and setting skip
+        template<typename Ftor, typename ReturnCode = ReturnCode_t<Ftor>>
+        static ReturnCode visit_(bool &skip, Ftor &&ftor, const std::string &path, const Offsets &offsets, Kind kind)
+        {
+            skip = false;
+            if constexpr (std::is_invocable_v<Ftor, std::string_view, const Offsets &, Kind>)
+            {
+                const ReturnCode rc = ftor(std::string_view{path}, offsets, kind);
+                if constexpr (std::is_same_v<ReturnCode, Result>)
                 {
-                    L("Found ignore file " << fp);
-                    auto &ignore = ignore_stack_.emplace_back();
-                    ignore.basedir_size = dir.native().size();
-                    MSS(ignore.ignore.load_from_file(fp));
-                    added_ignore = true;
-                    break;
+                    if (rc == Result::Skip)
+                    {
+                        skip = true;
+                        return Result::Ok;
+                    }
                 }
+                return rc;
             }
-
-            // Add a dummy ignore, if needed.
-            if (ignore_stack_.empty())
+            else
             {
-                auto &ignore = ignore_stack_.emplace_back();
-                ignore.basedir_size = dir.native().size();
-                added_ignore = true;
+                if (kind != Kind::File)
+                    return mss::ok_value<ReturnCode>();
+                return file_ftor_(ftor, path, offsets);
             }
+        }
 
-            // &perf: Using readdir() is expected to be 10x faster
-            for (const auto &dir_entry : std::filesystem::directory_iterator(dir))
+        // Walks the folder in path, which is restored when done.
+        // on_enter is called for each folder that is walked, with the IgnoreLevel that applies to its entries.
+        template<typename Ftor, typename OnEnter, typename ReturnCode = ReturnCode_t<Ftor>>
+        ReturnCode call_(std::string &path, const IgnoreLevelPtr &level, Ftor &&ftor, OnEnter &&on_enter) const
+        {
+            MSS_BEGIN(ReturnCode);
+
+            const auto below = level ? level->stack.below(path) : rubr::glob::Below::Some;
+            if (below == rubr::glob::Below::All)
+                // Everything in path is ignored
+                MSS_RETURN_OK();
+
+            bool skip;
+            const Offsets root_offsets{.base = std::min(base_, path.size()), .name = path.rfind('/') + 1};
+            MSS(visit_(skip, ftor, path, root_offsets, Kind::Enter));
+            if (skip)
+                MSS_RETURN_OK();
+
+            auto cache = decision_cache_();
+
+            // A deque keeps references to frames valid while it grows
+            std::deque<Frame> frames;
+            std::size_t depth = 0;
+            auto push = [&](const DirReader *parent, const IgnoreLevelPtr &level, rubr::glob::Below below) {
+                if (depth == frames.size())
+                    frames.emplace_back(config_.backend);
+                auto &frame = frames[depth];
+                if (!open_frame_(frame, path, parent, level, below))
+                    return false;
+                ++depth;
+                return on_enter(path, frame.level);
+            };
+
+            MSS(push(nullptr, level, below));
+            while (depth > 0)
             {
-                const auto &ignore = ignore_stack_.back();
-                
-                const auto &fullpath = dir_entry.path();
-                const std::string_view fullpath_sv = fullpath.native();
-                const std::string_view relpath = fullpath_sv.substr(ignore.basedir_size+1);
-                L(C(relpath));
-
-                if (!config_.include_hidden && rubr::fs::is_hidden(relpath))
+                auto &frame = frames[depth - 1];
+
+                Type type;
+                if (!next_entry_(frame, path, type, cache ? &*cache : nullptr))
                 {
-                    L("Skipping hidden path " << fullpath);
+                    MSS(frame.valid);
+                    close_frame_(frame, path);
+                    --depth;
+                    MSS(visit_(skip, ftor, path, depth > 0 ? frames[depth - 1].offsets : root_offsets, Kind::Leave));
                     continue;
                 }
 
-                if (ignore.ignore(relpath))
+                if (type == Type::File)
                 {
-                    L("Skipping ignored path " << fullpath);
-                    continue;
+                    L("Found regular file " << path);
+                    MSS(visit_(skip, ftor, path, frame.offsets, Kind::File));
                 }
-
-                if (dir_entry.is_regular_file())
+                else
                 {
-                    L("Found regular file " << fullpath);
-                    MSS(ftor(fullpath));
+                    L("Found directory " << path);
+                    MSS(visit_(skip, ftor, path, frame.offsets, Kind::Enter));
+                    if (skip)
+                        continue;
+                    MSS(push(&frame.reader, frame.level, frame.below));
                 }
-                else if (dir_entry.is_directory())
+            }
+
+            MSS_END();
+        }
+
+        // Leave is called as soon as the entries of a folder are done, while its subfolders might still be walked.
+        template<typename Ftor, typename ReturnCode = ReturnCode_t<Ftor>>
+        ReturnCode call_parallel_(Ftor &&ftor) const
+        {
+            MSS_BEGIN(ReturnCode);
+
+            Task root;
+            root.dir = basedir_;
+            root.offsets = {.base = root.dir.size(), .name = root.dir.rfind('/') + 1};
+
+            bool skip;
+            MSS(visit_(skip, ftor, root.dir, root.offsets, Kind::Enter));
+            if (skip)
+                MSS_RETURN_OK();
+
+            thread::WorkQueue<Task> queue{thread_count_()};
+            queue.push(0, std::move(root));
+
+            std::mutex error_mutex;
+            std::optional<ReturnCode> error;
+
+            auto worker = [&](std::size_t worker_ix) {
+                std::string path;
+                init_path_(path);
+                Frame frame{config_.backend};
+                auto cache = decision_cache_();
+
+                auto walk = [&](const Task &task) {
+                    MSS_BEGIN(ReturnCode);
+
+                    path = task.dir;
+                    MSS(open_frame_(frame, path, nullptr, task.level, task.below));
+
+                    bool skip;
+                    for (Type type; next_entry_(frame, path, type, cache ? &*cache : nullptr);)
+                    {
+                        if (type == Type::File)
+                        {
+                            MSS(visit_(skip, ftor, path, frame.offsets, Kind::File));
+                        }
+                        else
+                        {
+                            MSS(visit_(skip, ftor, path, frame.offsets, Kind::Enter));
+                            if (!skip)
+                                queue.push(worker_ix, Task{.dir = path, .level = frame.level, .offsets = frame.offsets, .below = frame.below});
+                        }
+                    }
+                    MSS(frame.valid);
+                    close_frame_(frame, path);
+
+                    MSS(visit_(skip, ftor, path, task.offsets, Kind::Leave));
+
+                    MSS_END();
+                };
+
+                for (Task task; queue.pop(worker_ix, task); queue.done())
                 {
-                    L("Found directory " << fullpath);
-                    MSS(call_(fullpath, ftor));
+                    const ReturnCode rc = walk(task);
+                    if (!mss::is_ok(rc))
+                    {
+                        std::lock_guard<std::mutex> lock{error_mutex};
+                        if (!error)
+                            error = rc;
+                        queue.stop();
+                    }
                 }
+            };
+
+            {
+                std::vector<std::jthread> threads;
+                for (std::size_t worker_ix = 0; worker_ix < queue.worker_count(); ++worker_ix)
+                    threads.emplace_back(worker, worker_ix);
             }
 
-            if (added_ignore)
-                ignore_stack_.pop_back();
+            if (error)
+                MSS(*error);
 
             MSS_END();
         }
 
         const Config config_;
-        struct Ignore
-        {
-            rubr::glob::Ignore ignore;
-            std::size_t basedir_size = 0;
-        };
-        std::vector<Ignore> ignore_stack_;
+        // Config.basedir without trailing '/'
+        const std::string basedir_;
+        // Start of the path relative to basedir_
+        const std::size_t base_;
+        std::unique_ptr<Index> index_;
+        std::unique_ptr<rubr::glob::IgnoreCache> ignore_cache_;
+        mutable std::atomic<std::size_t> replay_count_{0};
     };
 
 } // namespace rubr::fs
@@ -0,0 +1,288 @@
+#include <rubr/fs/Watcher.hpp>
+#include <rubr/platform.h>
+
+#if RUBR_PLATFORM_OS_LINUX
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+
+namespace rubr::fs {
+
+    namespace {
+        Walker::Config walker_config(const Watcher::Config &config)
+        {
+            Walker::Config res;
+            res.basedir = config.basedir;
+            res.include_hidden = config.include_hidden;
+            res.backend = config.backend;
+            return res;
+        }
+
+        // Room for at least 64 events with a maximal name
+        constexpr std::size_t c_buffer_size = 64 * (16 + 256);
+
+        bool is_below(const std::string &path, const std::string &dir)
+        {
+            return path.starts_with(dir) && (path.size() == dir.size() || dir.ends_with('/') || path[dir.size()] == '/');
+        }
+    } // namespace
+
+    Watcher::Watcher(const Config &config)
+        : walker_(walker_config(config))
+    {
+    }
+
+    Watcher::~Watcher()
+    {
+#if RUBR_PLATFORM_OS_LINUX
+        if (fd_ >= 0)
+            ::close(fd_);
+#endif
+    }
+
+    bool Watcher::open_()
+    {
+        MSS_BEGIN(bool);
+
+#if RUBR_PLATFORM_OS_LINUX
+        MSS(fd_ < 0, L("Watcher was already started"));
+        fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        MSS(fd_ >= 0);
+        buffer_.reset(new char[c_buffer_size]);
+#else
+        MSS(false, L("Watcher is only supported on Linux"));
+#endif
+
+        MSS_END();
+    }
+
+    bool Watcher::watch_(const std::string &dir, const Walker::IgnoreLevelPtr &level)
+    {
+        MSS_BEGIN(bool);
+
+#if RUBR_PLATFORM_OS_LINUX
+        const std::uint32_t mask = IN_CREATE | IN_MODIFY | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+        const int wd = ::inotify_add_watch(fd_, dir.c_str(), mask);
+        MSS(wd >= 0, L("Could not watch " << dir));
+
+        // The same folder can be reached twice via a symlink, we keep reporting it via its first path
+        if (!watches_.contains(wd))
+        {
+            watches_[wd] = Watch{.dir = dir, .level = level};
+            wds_[dir] = wd;
+        }
+#endif
+
+        MSS_END();
+    }
+
+    void Watcher::unwatch_(const std::string &dir)
+    {
+        for (auto it = wds_.lower_bound(dir); it != wds_.end() && it->first.starts_with(dir);)
+        {
+            if (!is_below(it->first, dir))
+            {
+                ++it;
+                continue;
+            }
+#if RUBR_PLATFORM_OS_LINUX
+            ::inotify_rm_watch(fd_, it->second);
+#endif
+            watches_.erase(it->second);
+            it = wds_.erase(it);
+        }
+    }
+
+    bool Watcher::read_(int timeout_ms)
+    {
+        MSS_BEGIN(bool);
+
+        pending_.clear();
+        pool_.clear();
+        rescans_.clear();
+
+#if RUBR_PLATFORM_OS_LINUX
+        MSS(fd_ >= 0, L("Watcher was not started"));
+
+        pollfd pfd{.fd = fd_, .events = POLLIN, .revents = 0};
+        const int count = ::poll(&pfd, 1, timeout_ms);
+        if (count < 0 && errno == EINTR)
+            MSS_RETURN_OK();
+        MSS(count >= 0);
+
+        while (count > 0)
+        {
+            const ssize_t size = ::read(fd_, buffer_.get(), c_buffer_size);
+            if (size < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                MSS(errno == EAGAIN);
+                break;
+            }
+            for (ssize_t offset = 0; offset < size;)
+            {
+                const auto *event = (const inotify_event *)(buffer_.get() + offset);
+                process_(event);
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        // Only the outermost folders have to be rescanned
+        std::sort(rescans_.begin(), rescans_.end());
+        const std::string *prev = nullptr;
+        for (const auto &dir : rescans_)
+        {
+            if (prev && is_below(dir, *prev))
+                continue;
+            prev = &dir;
+            if (!rescan_(dir))
+                L("Could not rescan " << dir);
+        }
+#endif
+
+        MSS_END();
+    }
+
+    void Watcher::process_(const void *ptr)
+    {
+        S(nullptr);
+
+#if RUBR_PLATFORM_OS_LINUX
+        const auto &event = *(const inotify_event *)ptr;
+
+        if (event.mask & IN_Q_OVERFLOW)
+        {
+            L("Event queue overflowed");
+            rescans_.push_back(walker_.basedir_);
+            return;
+        }
+
+        const auto it = watches_.find(event.wd);
+        if (it == watches_.end())
+            // Already removed
+            return;
+
+        if (event.mask & IN_IGNORED)
+        {
+            // The watched folder itself was removed
+            const auto wd_it = wds_.find(it->second.dir);
+            if (wd_it != wds_.end() && wd_it->second == event.wd)
+                wds_.erase(wd_it);
+            watches_.erase(it);
+            return;
+        }
+
+        if (event.len == 0)
+            return;
+
+        // Copy the watch, it might be removed below
+        const auto dir = it->second.dir;
+        const auto level = it->second.level;
+        const std::string_view name{event.name};
+
+        if (name == ".gitignore")
+        {
+            L("Ignore rules changed in " << dir);
+            rescans_.push_back(dir);
+            return;
+        }
+
+        if (!walker_.config_.include_hidden && name[0] == '.')
+            return;
+
+        std::string path = dir;
+        const auto name_offset = Walker::name_offset_(dir);
+        if (name_offset > dir.size())
+            path += '/';
+        path += name;
+
+        if (level->stack(path, path.size() - name.size()))
+        {
+            L("Skipping ignored path " << path);
+            return;
+        }
+
+        Kind kind;
+        if (event.mask & IN_CREATE)
+            kind = Kind::Create;
+        else if (event.mask & IN_MODIFY)
+            kind = Kind::Modify;
+        else if (event.mask & IN_DELETE)
+            kind = Kind::Delete;
+        else if (event.mask & IN_MOVED_FROM)
+            kind = Kind::MoveFrom;
+        else if (event.mask & IN_MOVED_TO)
+            kind = Kind::MoveTo;
+        else
+            return;
+
+        if (event.mask & IN_ISDIR)
+        {
+            switch (kind)
+            {
+                case Kind::Create:
+                case Kind::MoveTo:
+                    // Files might already have been added before the watch was in place
+                    if (!walk_(path, level, kind))
+                        L("Could not walk " << path);
+                    break;
+                case Kind::Delete:
+                case Kind::MoveFrom:
+                    unwatch_(path);
+                    add_(kind, Type::Directory, path, name_offset);
+                    break;
+                default: break;
+            }
+        }
+        else
+        {
+            add_(kind, Type::File, path, name_offset);
+        }
+#endif
+    }
+
+    bool Watcher::walk_(const std::string &dir, const Walker::IgnoreLevelPtr &level, Kind kind)
+    {
+        std::string path;
+        walker_.init_path_(path);
+        path = dir;
+        auto on_file = [&](std::string_view file, const Walker::Offsets &offsets) {
+            add_(kind, Type::File, file, offsets.name);
+            return true;
+        };
+        auto on_enter = [&](const std::string &dir, const Walker::IgnoreLevelPtr &level) {
+            return watch_(dir, level);
+        };
+        return walker_.call_(path, level, on_file, on_enter);
+    }
+
+    bool Watcher::rescan_(const std::string &dir)
+    {
+        MSS_BEGIN(bool);
+
+        const auto wd_it = wds_.find(dir);
+        MSS_Q(wd_it != wds_.end());
+        const auto &level = watches_[wd_it->second].level;
+
+        // The rules that apply to dir itself, without those of its own '.gitignore'
+        const auto outer = level->base == Walker::name_offset_(dir) ? level->parent : level;
+
+        unwatch_(dir);
+        add_(Kind::Rescan, Type::Directory, dir, dir.rfind('/') + 1);
+        MSS(walk_(dir, outer, Kind::Create));
+
+        MSS_END();
+    }
+
+    void Watcher::add_(Kind kind, Type type, std::string_view path, std::size_t name)
+    {
+        pending_.push_back(Pending{.kind = kind, .type = type, .begin = pool_.size(), .size = path.size(), .name = name});
+        pool_ += path;
+    }
+
+} // namespace rubr::fs
@@ -0,0 +1,156 @@
+#ifndef HEADER_rubr_fs_Watcher_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_fs_Watcher_hpp_ALREADY_INCLUDED
+
+#include <rubr/fs/Walker.hpp>
+#include <rubr/mss.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rubr::fs {
+
+    // Reports changes below a folder without walking it over and over again:
+    // after an initial walk, each folder that is not hidden or ignored is watched with inotify.
+    // Events are filtered with the same '.gitignore' rules as fs::Walker uses, and a change to a '.gitignore'
+    // results in a Rescan of its folder. Only supported on Linux, start() fails on other platforms.
+    class Watcher
+    {
+    public:
+        struct Config
+        {
+            std::filesystem::path basedir;
+            bool include_hidden = false;
+            Backend backend = Backend::Std;
+        };
+
+        enum class Kind
+        {
+            Create,
+            Modify,
+            Delete,
+            MoveFrom,
+            MoveTo,
+            // Everything previously reported below path must be considered stale.
+            // It is followed by a Create for each file that is currently present below path.
+            Rescan,
+        };
+
+        struct Event
+        {
+            Kind kind = Kind::Create;
+            // Directory is only used for Delete, MoveFrom and Rescan: files in a folder that is created or moved in
+            // are reported individually with Create or MoveTo.
+            Type type = Type::File;
+            // Points into a reused buffer and is only valid during the call
+            std::string_view path;
+            Walker::Offsets offsets;
+        };
+
+        Watcher(const Config &config);
+        ~Watcher();
+
+        Watcher(const Watcher &) = delete;
+        Watcher &operator=(const Watcher &) = delete;
+
+        // Does the initial walk and calls ftor(const Event &) with a Create for each file found
+        template<typename Ftor>
+        bool start(Ftor &&ftor)
+        {
+            MSS_BEGIN(bool);
+
+            MSS(open_());
+
+            std::string path;
+            walker_.init_path_(path);
+            Event event;
+            auto on_file = [&](std::string_view file, const Walker::Offsets &offsets) {
+                event.path = file;
+                event.offsets = offsets;
+                return ftor(std::as_const(event));
+            };
+            auto on_enter = [&](const std::string &dir, const Walker::IgnoreLevelPtr &level) {
+                return watch_(dir, level);
+            };
+            MSS(walker_.call_(path, nullptr, on_file, on_enter));
+
+            MSS_END();
+        }
+
+        // Can be used to wait for changes in an external event loop
+        int fd() const { return fd_; }
+
+        // Waits at most timeout_ms (-1 waits forever) for changes and calls ftor(const Event &) for each of them
+        template<typename Ftor>
+        bool poll(Ftor &&ftor, int timeout_ms)
+        {
+            MSS_BEGIN(bool);
+
+            MSS(read_(timeout_ms));
+
+            for (const auto &pending : pending_)
+            {
+                const Event event{
+                    .kind = pending.kind,
+                    .type = pending.type,
+                    .path = std::string_view{pool_}.substr(pending.begin, pending.size),
+                    .offsets = {.base = walker_.base_, .name = pending.name},
+                };
+                MSS(ftor(event));
+            }
+
+            MSS_END();
+        }
+
+    private:
+        struct Watch
+        {
+            std::string dir;
+            Walker::IgnoreLevelPtr level;
+        };
+
+        // Event with its path stored in pool_, to avoid an allocation per event
+        struct Pending
+        {
+            Kind kind;
+            Type type;
+            std::size_t begin;
+            std::size_t size;
+            std::size_t name;
+        };
+
+        bool open_();
+        bool watch_(const std::string &dir, const Walker::IgnoreLevelPtr &level);
+        // Removes the watches of dir and all its subfolders
+        void unwatch_(const std::string &dir);
+
+        // Reads all available events into pending_
+        bool read_(int timeout_ms);
+        void process_(const void *event);
+        // Walks dir, watching its subfolders and adding a file event of the given kind for each file
+        bool walk_(const std::string &dir, const Walker::IgnoreLevelPtr &level, Kind kind);
+        bool rescan_(const std::string &dir);
+        void add_(Kind kind, Type type, std::string_view path, std::size_t name);
+
+        Walker walker_;
+        int fd_ = -1;
+        std::unique_ptr<char[]> buffer_;
+
+        std::unordered_map<int, Watch> watches_;
+        // Ordered to find all subfolders of a folder
+        std::map<std::string, int> wds_;
+
+        std::vector<Pending> pending_;
+        std::string pool_;
+        std::vector<std::string> rescans_;
+    };
+
+} // namespace rubr::fs
+
+#endif
@@ -0,0 +1,51 @@
+#include <rubr/glob/DecisionCache.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace rubr::glob {
+
+    DecisionCache::DecisionCache(std::size_t capacity)
+        : entries_(std::bit_ceil(std::max<std::size_t>(capacity, 1)))
+    {
+    }
+
+    const Ignore::Rule *DecisionCache::match(const Ignore &ignore, const std::string_view &fp, std::size_t name)
+    {
+        const auto id = ignore.id();
+        if (id == 0)
+            // Nothing was loaded, there is nothing to match either
+            return nullptr;
+
+        std::string_view key = fp;
+        if (ignore.name_only())
+            key.remove_prefix(name != Glob::npos ? name : fp.rfind('/') + 1);
+        const std::uint64_t hash = std::hash<std::string_view>{}(key);
+
+        // Mixing in the id spreads the same name over different slots for different Ignores
+        auto &entry = entries_[(hash ^ (id * 0x9e3779b97f4a7c15ull)) & (entries_.size() - 1)];
+        const auto &rules = ignore.rules();
+        if (entry.ignore == id && entry.hash == hash && entry.key == key)
+        {
+            ++hit_count_;
+            return entry.rule != c_no_rule ? &rules[entry.rule] : nullptr;
+        }
+
+        ++miss_count_;
+        const auto rule = ignore.match(fp, name);
+        entry.ignore = id;
+        entry.hash = hash;
+        entry.key.assign(key);
+        entry.rule = rule ? std::uint32_t(rule - rules.data()) : c_no_rule;
+        return rule;
+    }
+
+    void DecisionCache::clear()
+    {
+        entries_.assign(entries_.size(), Entry{});
+        hit_count_ = 0;
+        miss_count_ = 0;
+    }
+
+} // namespace rubr::glob
@@ -0,0 +1,63 @@
+#ifndef HEADER_rubr_glob_DecisionCache_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_glob_DecisionCache_hpp_ALREADY_INCLUDED
+
+#include <rubr/glob/Ignore.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rubr::glob {
+
+    // Bounded memo of Ignore::match() results, for names that are tested against the same Ignore over and over,
+    // like `build`, `CMakeFiles` or `*.o` files during a walk.
+    // Entries are keyed by the Ignore::id() and a hash of the path. For an Ignore::name_only() Ignore, only the
+    // name is hashed, which makes the decision for all files with the same name free after the first.
+    // Reloading an Ignore changes its id(), which invalidates its entries without touching the cache.
+    // The hashed name or path is stored as well: a hash collision results in a miss, not in the decision for another path.
+    // The table is direct-mapped: a new entry replaces the one in its slot. Not thread-safe, use one per thread.
+    class DecisionCache
+    {
+    public:
+        // capacity is rounded up to a power of 2
+        explicit DecisionCache(std::size_t capacity = 4096);
+
+        // Same as ignore.match(fp, name)
+        const Ignore::Rule *match(const Ignore &ignore, const std::string_view &fp, std::size_t name = Glob::npos);
+        // Same as ignore(fp, name)
+        bool operator()(const Ignore &ignore, const std::string_view &fp, std::size_t name = Glob::npos)
+        {
+            const auto rule = match(ignore, fp, name);
+            return rule && !rule->include;
+        }
+
+        void clear();
+
+        std::size_t capacity() const { return entries_.size(); }
+        std::size_t hit_count() const { return hit_count_; }
+        std::size_t miss_count() const { return miss_count_; }
+
+    private:
+        static constexpr std::uint32_t c_no_rule = -1;
+
+        struct Entry
+        {
+            // 0 for an empty slot
+            std::uint64_t ignore = 0;
+            std::uint64_t hash = 0;
+            // Name or path that was hashed, its capacity is reused when the slot is replaced
+            std::string key;
+            // Index into Ignore::rules(), or c_no_rule
+            std::uint32_t rule = c_no_rule;
+        };
+
+        std::vector<Entry> entries_;
+        std::size_t hit_count_ = 0;
+        std::size_t miss_count_ = 0;
+    };
+
+} // namespace rubr::glob
+
+#endif
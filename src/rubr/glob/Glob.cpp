@@ -1,73 +1,298 @@
 #include <rubr/debug/log.hpp>
 #include <rubr/glob/Glob.hpp>
+#include <rubr/mss.hpp>
+#include <rubr/strng/append.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 
 namespace rubr::glob {
 
-    Wildcard max(Wildcard a, Wildcard b)
+    Glob::Glob()
+        : Glob(Config{})
     {
-        return Wildcard(std::max(int(a), int(b)));
     }
 
     Glob::Glob(const Config &config)
+        : config_(config)
     {
-        if (config.pattern.empty())
+        split(config.front, config.pattern, config.back, [&](Wildcard wildcard, std::string_view str) {
+            auto &part = parts_.emplace_back();
+            part.wildcard = wildcard;
+            part.str = str;
+        });
+
+        for (std::size_t ix = 0; ix < parts_.size(); ++ix)
         {
-            parts_.push_back(Part{.wildcard = max(config.front, config.back), .str = ""});
-            return;
+            auto &part = parts_[ix];
+            init_part_(part);
+            if (!part.needle.empty() && (required_ix_ >= parts_.size() || part.size > parts_[required_ix_].size))
+                required_ix_ = ix;
         }
 
-        // Split config.pattern on '*' and convert to Parts
-        const std::string_view pattern = config.pattern;
-        Wildcard wildcard = config.front;
-        for (std::size_t search_pos = 0, ix; search_pos < pattern.size(); search_pos = ix + 1)
+        classify_();
+        compile_nfa_();
+
+        S(nullptr);
+        for (const auto &part : parts_)
         {
-            ix = pattern.find('*', search_pos);
+            L(C(part.wildcard, int) C(part.str));
+        }
+    }
 
-            if (ix == std::string_view::npos)
+    void Glob::init_part_(Part &part) const
+    {
+        part.size = atom_count(part.str);
+        const bool plain = is_literal(part.str);
+        part.literal = plain && !config_.ignore_case;
+        part.sets.clear();
+        if (!part.literal)
+        {
+            for (std::size_t pos = 0, size; pos < part.str.size(); pos += size)
             {
-                // No wildcard found: add this part and stop
-                parts_.push_back(Part{.wildcard = wildcard, .str = std::string(pattern.substr(search_pos))});
-                wildcard = Wildcard::Nothing;
-                break;
+                size = atom_size(part.str, pos);
+                part.sets.push_back(atom_set(std::string_view{part.str}.substr(pos, size), config_.ignore_case));
             }
+        }
+        part.needle = plain ? strng::Needle{part.str, config_.ignore_case} : strng::Needle{};
+    }
 
-            if (ix == search_pos)
-            {
-                // We found a wildcard at the start, merge it with the one already present
-                wildcard = max(wildcard, Wildcard::Some);
-            }
-            else
+    void Glob::write(std::string &dst) const
+    {
+        strng::append_lsb(dst, (std::uint8_t)config_.front);
+        strng::append_lsb(dst, (std::uint8_t)config_.back);
+        strng::append_lsb(dst, (std::uint8_t)config_.ignore_case);
+        strng::append_sized<std::uint32_t>(dst, config_.pattern);
+
+        strng::append_lsb(dst, (std::uint8_t)kind_);
+        strng::append_lsb(dst, (std::uint32_t)required_ix_);
+        strng::append_lsb(dst, (std::uint32_t)parts_.size());
+        for (const auto &part : parts_)
+        {
+            strng::append_lsb(dst, (std::uint8_t)part.wildcard);
+            strng::append_sized<std::uint32_t>(dst, part.str);
+        }
+
+        strng::append_lsb(dst, last_bit_);
+        strng::append_lsb(dst, (std::uint8_t)last_all_);
+        strng::append_lsb(dst, (std::uint32_t)classes_.size());
+        for (const auto &cls : classes_)
+        {
+            strng::append_lsb(dst, cls.advance);
+            strng::append_lsb(dst, cls.stay);
+        }
+        // Most bytes use class 0, only the others are written
+        const auto count = byte_classes_.size() - std::count(byte_classes_.begin(), byte_classes_.end(), 0);
+        strng::append_lsb(dst, (std::uint16_t)count);
+        for (std::size_t byte = 0; byte < byte_classes_.size(); ++byte)
+        {
+            if (byte_classes_[byte])
             {
-                // We found a non-wildcard at the start
-                parts_.push_back(Part{.wildcard = wildcard, .str = std::string(pattern.substr(search_pos, ix - search_pos))});
-                wildcard = Wildcard::Some;
+                strng::append_lsb(dst, (std::uint8_t)byte);
+                strng::append_lsb(dst, byte_classes_[byte]);
             }
+        }
+    }
+
+    bool Glob::read_header(Header &header, rubr::parse::Strange &src)
+    {
+        MSS_BEGIN(bool);
+
+        std::uint8_t front, back, ignore_case;
+        std::uint32_t size;
+        MSS(src.pop_lsb(front));
+        MSS(src.pop_lsb(back));
+        MSS(src.pop_lsb(ignore_case));
+        MSS(front <= (std::uint8_t)Wildcard::All && back <= (std::uint8_t)Wildcard::All);
+        rubr::parse::Strange pattern;
+        MSS(src.pop_lsb(size));
+        MSS(src.pop_count(pattern, size));
+
+        header = Header{.front = (Wildcard)front, .pattern = pattern.view(), .back = (Wildcard)back, .ignore_case = !!ignore_case};
 
-            // Upgrade the wildcard if more '*'s are present
-            while (ix + 1 < pattern.size() && pattern[ix + 1] == '*')
+        MSS_END();
+    }
+
+    bool Glob::read(rubr::parse::Strange &src)
+    {
+        MSS_BEGIN(bool);
+
+        Header header;
+        MSS(read_header(header, src));
+        Glob glob{Uncompiled{}};
+        glob.config_ = Config{.front = header.front, .pattern = std::string(header.pattern), .back = header.back, .ignore_case = header.ignore_case};
+
+        std::uint8_t kind;
+        std::uint32_t required_ix, part_count;
+        MSS(src.pop_lsb(kind));
+        MSS(kind <= (std::uint8_t)Kind::Generic);
+        glob.kind_ = (Kind)kind;
+        MSS(src.pop_lsb(required_ix));
+        MSS(src.pop_lsb(part_count));
+        // Each part takes at least 5 bytes
+        MSS(part_count > 0 && part_count <= src.size() / 5);
+        glob.parts_.reserve(part_count);
+        for (std::uint32_t ix = 0; ix < part_count; ++ix)
+        {
+            auto &part = glob.parts_.emplace_back();
+            std::uint8_t wildcard;
+            std::uint32_t size;
+            MSS(src.pop_lsb(wildcard));
+            MSS(wildcard <= (std::uint8_t)Wildcard::All);
+            part.wildcard = (Wildcard)wildcard;
+            MSS(src.pop_lsb(size));
+            MSS(src.pop_string(part.str, size));
+            glob.init_part_(part);
+        }
+        // Only the last part is empty, and the special Kinds assume a single literal part
+        MSS(glob.parts_.back().str.empty());
+        MSS(glob.kind_ == Kind::Generic || (part_count == 2 && glob.parts_[0].literal));
+        glob.required_ix_ = required_ix == std::uint32_t(-1) ? std::size_t(-1) : required_ix;
+        MSS(glob.required_ix_ == std::size_t(-1) || (glob.required_ix_ < part_count && !glob.parts_[glob.required_ix_].needle.empty()));
+
+        std::uint8_t last_all;
+        std::uint32_t class_count;
+        std::uint16_t byte_count;
+        MSS(src.pop_lsb(glob.last_bit_));
+        MSS(src.pop_lsb(last_all));
+        glob.last_all_ = !!last_all;
+        MSS(src.pop_lsb(class_count));
+        MSS(class_count <= src.size() / 16 && class_count <= glob.byte_classes_.size());
+        // step_() uses class 0 and 1 as soon as the NFA is used
+        MSS(!glob.last_bit_ || class_count >= 2);
+        glob.classes_.resize(class_count);
+        for (auto &cls : glob.classes_)
+        {
+            MSS(src.pop_lsb(cls.advance));
+            MSS(src.pop_lsb(cls.stay));
+        }
+        glob.byte_classes_.fill(0);
+        MSS(src.pop_lsb(byte_count));
+        MSS(byte_count <= glob.byte_classes_.size());
+        for (std::uint16_t ix = 0; ix < byte_count; ++ix)
+        {
+            std::uint8_t byte, cls;
+            MSS(src.pop_lsb(byte));
+            MSS(src.pop_lsb(cls));
+            MSS(cls < class_count);
+            glob.byte_classes_[byte] = cls;
+        }
+
+        *this = std::move(glob);
+
+        MSS_END();
+    }
+
+    void Glob::classify_()
+    {
+        kind_ = Kind::Generic;
+        if (parts_.size() != 2 || !parts_[0].literal)
+            return;
+
+        const auto front = parts_[0].wildcard;
+        const auto back = parts_[1].wildcard;
+        const bool has_slash = parts_[0].str.contains('/');
+        if (front == Wildcard::Nothing)
+            kind_ = back == Wildcard::Nothing ? Kind::Exact : Kind::Prefix;
+        else if (back == Wildcard::Nothing)
+        {
+            // A Some-wildcard in front of a literal with '/' cannot be checked with the name offset
+            if (front == Wildcard::All || !has_slash)
+                kind_ = Kind::Suffix;
+        }
+        else if (front == Wildcard::All && back == Wildcard::Some && !has_slash)
+            kind_ = Kind::Basename;
+    }
+
+    bool Glob::operator()(const std::string_view &str, std::size_t name) const
+    {
+        S(nullptr);
+        L(C(this)C(str) C(name));
+
+        auto get_name = [&]() {
+            // rfind() returns npos when there is no '/', which results in 0
+            return name != npos ? name : str.rfind('/') + 1;
+        };
+
+        switch (kind_)
+        {
+            case Kind::Exact: return str == parts_[0].str;
+            case Kind::Prefix:
             {
-                wildcard = Wildcard::All;
-                ++ix;
+                // A Some-wildcard at the back requires the last '/' to be part of the literal
+                const auto &literal = parts_[0].str;
+                return str.starts_with(literal) && (parts_[1].wildcard == Wildcard::All || get_name() <= literal.size());
             }
+            case Kind::Suffix:
+                // A Some-wildcard at the front requires the absence of '/' as the literal has none
+                return str.ends_with(parts_[0].str) && (parts_[0].wildcard == Wildcard::All || get_name() == 0);
+            case Kind::Basename: return parts_[0].needle.find(str.substr(get_name())) != strng::Needle::npos;
+            case Kind::Generic: break;
         }
 
-        // Add the last empty part
-        parts_.push_back(Part{.wildcard = max(wildcard, config.back), .str = ""});
+        if (required_ix_ < parts_.size() && parts_[required_ix_].needle.find(str) == strng::Needle::npos)
+            return false;
 
-        S(nullptr);
-        for (const auto &part : parts_)
+        if (!last_bit_)
+            return match_(0, str);
+
+        std::uint64_t positions = 1;
+        for (const auto ch : str)
         {
-            L(C(part.wildcard, int) C(part.str));
+            positions = step_(positions, (std::uint8_t)ch);
+            if (!positions)
+                return false;
         }
+        return positions & last_bit_;
     }
 
-    bool Glob::operator()(const std::string_view &str) const
+    void Glob::operator()(std::span<const std::string_view> strs, Mask &mask) const
+    {
+        mask.assign((strs.size() + 63) / 64, 0);
+        auto set = [&](std::size_t ix, bool matches) {
+            mask[ix / 64] |= std::uint64_t{matches} << (ix % 64);
+        };
+
+        const auto &literal = parts_[0].str;
+        switch (kind_)
+        {
+            case Kind::Exact:
+                for (std::size_t ix = 0; ix < strs.size(); ++ix)
+                    set(ix, strs[ix] == literal);
+                return;
+            case Kind::Suffix:
+                if (parts_[0].wildcard == Wildcard::All && literal.size() <= 8)
+                {
+                    // Compare the last 8 bytes of each string with the literal, masking off the bytes in front of it.
+                    // memcpy() keeps this independent of the byte order.
+                    std::uint64_t word = 0, keep = 0;
+                    std::memcpy((char *)&word + 8 - literal.size(), literal.data(), literal.size());
+                    std::memset((char *)&keep + 8 - literal.size(), 0xff, literal.size());
+                    for (std::size_t ix = 0; ix < strs.size(); ++ix)
+                    {
+                        const auto &str = strs[ix];
+                        if (str.size() >= 8)
+                        {
+                            std::uint64_t tail;
+                            std::memcpy(&tail, str.data() + str.size() - 8, 8);
+                            set(ix, ((tail ^ word) & keep) == 0);
+                        }
+                        else
+                            set(ix, str.ends_with(literal));
+                    }
+                    return;
+                }
+                break;
+            default: break;
+        }
+
+        for (std::size_t ix = 0; ix < strs.size(); ++ix)
+            set(ix, (*this)(strs[ix]));
+    }
+
+    bool Glob::match_backtrack(const std::string_view &str) const
     {
-        S(nullptr);
-        L(C(this)C(str));
         return match_(0, str);
     }
 
@@ -93,17 +318,34 @@ namespace rubr::glob {
 
         for (std::size_t search_pos = 0, ix; search_pos < sv.size(); search_pos = ix + 1)
         {
-            ix = sv.find(part.str, search_pos);
+            ix = find_(part, sv, search_pos);
             if (ix == std::string_view::npos)
                 break;
 
-            if (match_(part.wildcard, sv.substr(0, ix)) && match_(part_ix + 1, sv.substr(ix + part.str.size())))
+            if (match_(part.wildcard, sv.substr(0, ix)) && match_(part_ix + 1, sv.substr(ix + part.size)))
                 return true;
         }
 
         return false;
     }
 
+    std::size_t Glob::find_(const Part &part, const std::string_view &sv, std::size_t pos) const
+    {
+        if (!part.needle.empty())
+            return part.needle.find(sv, pos);
+
+        // Part with '?' or bracket expressions
+        for (; pos + part.size <= sv.size(); ++pos)
+        {
+            std::size_t ix = 0;
+            while (ix < part.size && part.sets[ix].contains(sv[pos + ix]))
+                ++ix;
+            if (ix == part.size)
+                return pos;
+        }
+        return std::string_view::npos;
+    }
+
     bool Glob::match_(Wildcard wildcard, const std::string_view &sv) const
     {
         bool ret = false;
@@ -118,4 +360,120 @@ namespace rubr::glob {
         return ret;
     }
 
+    void Glob::compile_nfa_()
+    {
+        byte_classes_.fill(0);
+        classes_.assign(2, ByteClass{});
+        byte_classes_['/'] = 1;
+        last_bit_ = 0;
+        last_all_ = false;
+
+        std::size_t position_count = 0;
+        for (const auto &part : parts_)
+            position_count += std::max<std::size_t>(part.size, 1);
+        if (position_count > c_max_positions)
+        {
+            // Too long for the NFA, matching falls back to backtracking and below() will be conservative
+            classes_.clear();
+            byte_classes_.fill(0);
+            return;
+        }
+
+        std::array<std::uint64_t, 256> advance{};
+        std::uint64_t some_mask = 0, all_mask = 0;
+        std::size_t ix = 0;
+        for (const auto &part : parts_)
+        {
+            const std::uint64_t bit = std::uint64_t{1} << ix;
+            switch (part.wildcard)
+            {
+                case Wildcard::Nothing: break;
+                case Wildcard::Some: some_mask |= bit; break;
+                case Wildcard::All: all_mask |= bit; break;
+            }
+
+            for (std::size_t atom_ix = 0; atom_ix < part.size; ++atom_ix)
+            {
+                const auto position = std::uint64_t{1} << ix;
+                if (part.literal)
+                    advance[(std::uint8_t)part.str[atom_ix]] |= position;
+                else
+                {
+                    for (unsigned int byte = 0; byte < 256; ++byte)
+                    {
+                        if (part.sets[atom_ix].contains(byte))
+                            advance[byte] |= position;
+                    }
+                }
+                ++ix;
+            }
+
+            if (part.str.empty())
+            {
+                // The final part has no literal and gets a position that is never advanced
+                last_bit_ = bit;
+                last_all_ = part.wildcard == Wildcard::All;
+                ++ix;
+            }
+        }
+
+        // Bytes with the same advance mask share a class, a handful for typical patterns
+        classes_[1].advance = advance['/'];
+        for (unsigned int byte = 0; byte < 256; ++byte)
+        {
+            if (byte == '/' || !advance[byte])
+                continue;
+            auto it = std::find_if(classes_.begin() + 2, classes_.end(), [&](const auto &cls) { return cls.advance == advance[byte]; });
+            if (it == classes_.end())
+            {
+                if (classes_.size() == byte_classes_.size())
+                {
+                    // Only possible for contrived bracket expressions, the class does not fit in byte_classes_
+                    classes_.clear();
+                    byte_classes_.fill(0);
+                    last_bit_ = 0;
+                    last_all_ = false;
+                    return;
+                }
+                classes_.push_back(ByteClass{.advance = advance[byte]});
+                it = classes_.end() - 1;
+            }
+            byte_classes_[byte] = it - classes_.begin();
+        }
+
+        for (std::size_t class_ix = 0; class_ix < classes_.size(); ++class_ix)
+            classes_[class_ix].stay = class_ix == 1 ? all_mask : (some_mask | all_mask);
+    }
+
+    bool Glob::all_only_in_front() const
+    {
+        return std::none_of(parts_.begin() + std::min<std::size_t>(parts_.size(), 1), parts_.end(), [](const Part &part) { return part.wildcard == Wildcard::All; });
+    }
+
+    Below Glob::below(const std::string_view &dir) const
+    {
+        if (!last_bit_)
+            return Below::Some;
+
+        std::uint64_t positions = 1;
+        if (!dir.empty())
+        {
+            for (const auto ch : dir)
+            {
+                positions = step_(positions, (std::uint8_t)ch);
+                if (!positions)
+                    return Below::None;
+            }
+            positions = step_(positions, '/');
+            if (!positions)
+                return Below::None;
+        }
+
+        // Once the final part is reached with an All wildcard, anything that follows matches
+        if ((positions & last_bit_) && last_all_)
+            return Below::All;
+
+        return Below::Some;
+    }
+
 } // namespace rubr::glob
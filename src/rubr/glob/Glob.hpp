@@ -1,7 +1,14 @@
 #ifndef HEADER_rubr_glob_Glob_hpp_ALREADY_INCLUDED
 #define HEADER_rubr_glob_Glob_hpp_ALREADY_INCLUDED
 
+#include <rubr/parse/Strange.hpp>
+#include <rubr/strng/Needle.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace rubr::glob {
@@ -13,7 +20,191 @@ namespace rubr::glob {
         All,
     };
 
-    Wildcard max(Wildcard a, Wildcard b);
+    constexpr Wildcard max(Wildcard a, Wildcard b)
+    {
+        return int(a) < int(b) ? b : a;
+    }
+
+    // Result of a batch match: bit `ix % 64` of word `ix / 64` is set when the string at ix matches
+    using Mask = std::vector<std::uint64_t>;
+
+    inline bool test(const Mask &mask, std::size_t ix)
+    {
+        return (mask[ix / 64] >> (ix % 64)) & 1;
+    }
+
+    // Which of the paths below a folder can be matched
+    enum class Below
+    {
+        None,
+        Some,
+        All,
+    };
+
+    // Bytes that can be matched at a single position of a pattern
+    struct ByteSet
+    {
+        std::array<std::uint64_t, 4> bits{};
+
+        constexpr void add(std::uint8_t byte) { bits[byte / 64] |= std::uint64_t{1} << (byte % 64); }
+        constexpr void remove(std::uint8_t byte) { bits[byte / 64] &= ~(std::uint64_t{1} << (byte % 64)); }
+        constexpr bool contains(std::uint8_t byte) const { return (bits[byte / 64] >> (byte % 64)) & 1; }
+    };
+
+    // Size of the atom at str[pos], which always matches a single byte: a bracket expression like `[a-z]` or `[!abc]`,
+    // or a single character. A ']' directly after the opening '[' or '[!' is part of the set, and a '[' without closing
+    // ']' is a literal character.
+    constexpr std::size_t atom_size(std::string_view str, std::size_t pos)
+    {
+        if (str[pos] != '[')
+            return 1;
+        auto ix = pos + 1;
+        if (ix < str.size() && (str[ix] == '!' || str[ix] == '^'))
+            ++ix;
+        if (ix < str.size() && str[ix] == ']')
+            ++ix;
+        const auto close = str.find(']', ix);
+        return close == std::string_view::npos ? 1 : close + 1 - pos;
+    }
+
+    // Bytes matched by an atom. As git does, '?' and bracket expressions never match '/'.
+    // With ignore_case, ASCII letters match both their lower- and uppercase variant.
+    constexpr ByteSet atom_set(std::string_view atom, bool ignore_case)
+    {
+        ByteSet set;
+        if (atom == "?")
+        {
+            set.bits.fill(~std::uint64_t{0});
+            set.remove('/');
+            return set;
+        }
+        if (atom.size() == 1)
+            set.add(atom[0]);
+
+        bool negate = false;
+        if (atom.size() > 1)
+        {
+            std::size_t ix = 1;
+            if (atom[ix] == '!' || atom[ix] == '^')
+            {
+                negate = true;
+                ++ix;
+            }
+            // The closing ']' is not part of the set
+            const auto end = atom.size() - 1;
+            for (; ix < end; ++ix)
+            {
+                const std::uint8_t from = atom[ix];
+                if (ix + 2 < end && atom[ix + 1] == '-')
+                {
+                    // Range, a trailing '-' is a literal
+                    const std::uint8_t to = atom[ix + 2];
+                    for (unsigned int byte = from; byte <= to; ++byte)
+                        set.add(byte);
+                    ix += 2;
+                }
+                else
+                    set.add(from);
+            }
+        }
+
+        if (ignore_case)
+        {
+            for (std::uint8_t lower = 'a'; lower <= 'z'; ++lower)
+            {
+                const std::uint8_t upper = lower - 'a' + 'A';
+                if (set.contains(lower) || set.contains(upper))
+                {
+                    set.add(lower);
+                    set.add(upper);
+                }
+            }
+        }
+        if (negate)
+        {
+            for (auto &bits : set.bits)
+                bits = ~bits;
+        }
+        if (atom.size() > 1)
+            set.remove('/');
+
+        return set;
+    }
+
+    // True when str only consists of literal characters, without '?' or bracket expressions
+    constexpr bool is_literal(std::string_view str)
+    {
+        for (std::size_t ix = 0; ix < str.size(); ix += atom_size(str, ix))
+        {
+            if (str[ix] == '?' || atom_size(str, ix) > 1)
+                return false;
+        }
+        return true;
+    }
+
+    // Number of bytes matched by str
+    constexpr std::size_t atom_count(std::string_view str)
+    {
+        std::size_t count = 0;
+        for (std::size_t ix = 0; ix < str.size(); ix += atom_size(str, ix))
+            ++count;
+        return count;
+    }
+
+    // Position of the first '*' in pattern at or after pos that is not part of a bracket expression
+    constexpr std::size_t find_star(std::string_view pattern, std::size_t pos)
+    {
+        for (; pos < pattern.size(); pos += atom_size(pattern, pos))
+        {
+            if (pattern[pos] == '*')
+                return pos;
+        }
+        return std::string_view::npos;
+    }
+
+    // Splits pattern on '*' and calls ftor(wildcard, str) for each part, with the wildcard that precedes it.
+    // A part can contain '?' and bracket expressions, but no '*'. A single '*' becomes Wildcard::Some and consecutive
+    // '*'s become Wildcard::All. The last part is always empty and carries the trailing wildcard.
+    // Shared between Glob and StaticGlob to guarantee identical matching.
+    template<typename Ftor>
+    constexpr void split(Wildcard front, std::string_view pattern, Wildcard back, Ftor &&ftor)
+    {
+        Wildcard wildcard = front;
+        for (std::size_t search_pos = 0, ix; search_pos < pattern.size(); search_pos = ix + 1)
+        {
+            ix = find_star(pattern, search_pos);
+
+            if (ix == std::string_view::npos)
+            {
+                // No wildcard found: add this part and stop
+                ftor(wildcard, pattern.substr(search_pos));
+                wildcard = Wildcard::Nothing;
+                break;
+            }
+
+            if (ix == search_pos)
+            {
+                // We found a wildcard at the start, merge it with the one already present
+                wildcard = max(wildcard, Wildcard::Some);
+            }
+            else
+            {
+                // We found a non-wildcard at the start
+                ftor(wildcard, pattern.substr(search_pos, ix - search_pos));
+                wildcard = Wildcard::Some;
+            }
+
+            // Upgrade the wildcard if more '*'s are present
+            while (ix + 1 < pattern.size() && pattern[ix + 1] == '*')
+            {
+                wildcard = Wildcard::All;
+                ++ix;
+            }
+        }
+
+        // Add the last empty part
+        ftor(max(wildcard, back), std::string_view{});
+    }
 
     class Glob
     {
@@ -23,22 +214,130 @@ namespace rubr::glob {
             Wildcard front = Wildcard::Nothing;
             std::string pattern;
             Wildcard back = Wildcard::Nothing;
+            // Match ASCII letters case-insensitively
+            bool ignore_case = false;
         };
 
+        static constexpr std::size_t npos = std::string_view::npos;
+
+        // Shape of the pattern, determined when it is compiled.
+        // Only patterns with literal parts that are matched case-sensitively get a special Kind.
+        enum class Kind
+        {
+            // A single literal: `/build`
+            Exact,
+            // A literal followed by a wildcard: `/build/`
+            Prefix,
+            // A wildcard followed by a literal: `*.log`
+            Suffix,
+            // A literal without '/' that must occur in the last path component: `cache*`
+            Basename,
+            // Anything else, matched with the NFA
+            Generic,
+        };
+
+        // Matches the empty string only, use read() to restore a serialized Glob
+        Glob();
         Glob(const Config &config);
 
-        bool operator()(const std::string_view &str) const;
+        const Config &config() const { return config_; }
+        Kind kind() const { return kind_; }
+
+        // Binary serialization of the compiled glob: its config, parts, Kind and NFA tables.
+        // read() restores these without compiling the pattern again.
+        void write(std::string &dst) const;
+        bool read(rubr::parse::Strange &src);
+
+        // Config at the start of the output of write(), to look up a Glob without reading it completely
+        struct Header
+        {
+            Wildcard front = Wildcard::Nothing;
+            std::string_view pattern;
+            Wildcard back = Wildcard::Nothing;
+            bool ignore_case = false;
+        };
+        static bool read_header(Header &header, rubr::parse::Strange &src);
+
+        // Patterns of a special Kind are matched with a single comparison. Generic patterns reject strings
+        // without their longest literal part with a SIMD search, and run in linear time when they match
+        // at most 63 bytes outside of wildcards. Longer patterns use match_backtrack().
+        // name is the offset of the last path component in str, e.g. Walker::Offsets::name. When it is npos,
+        // it is searched for when needed.
+        bool operator()(const std::string_view &str, std::size_t name = npos) const;
+        // Matches all strs at once, e.g. the entries of a folder. The Kind is dispatched once, and short
+        // suffixes are compared branch-free as a single word per string.
+        void operator()(std::span<const std::string_view> strs, Mask &mask) const;
+        // Reference implementation that backtracks over the parts, which can take exponential time
+        bool match_backtrack(const std::string_view &str) const;
+
+        // Static analysis of the paths `dir/...`, or of all paths when dir is empty.
+        // The result is conservative: Some is returned when the analysis cannot decide.
+        Below below(const std::string_view &dir) const;
+
+        // Set when only the leading wildcard can match across a '/': `**.o` or `*a*b`, but not `a**b` or `a**`
+        bool all_only_in_front() const;
 
     private:
+        friend class GlobSet;
+
+        // Creates a Glob without parts, to be filled by read()
+        struct Uncompiled
+        {
+        };
+        explicit Glob(Uncompiled) {}
+
+        struct Part;
+        void init_part_(Part &part) const;
+        void classify_();
+
         bool match_(std::size_t part_ix, const std::string_view &sv) const;
         bool match_(Wildcard wildcard, const std::string_view &sv) const;
+        // Position of the first match of part in sv at or after pos
+        std::size_t find_(const Part &part, const std::string_view &sv, std::size_t pos) const;
+
+        // Shift-And NFA over parts_, with a position per matched byte and one for the final part.
+        // A set of positions fits in a std::uint64_t, which limits the NFA to patterns that match at most 63 bytes.
+        static constexpr std::size_t c_max_positions = 64;
+        void compile_nfa_();
+        std::uint64_t step_(std::uint64_t positions, std::uint8_t byte) const
+        {
+            const auto &cls = classes_[byte_classes_[byte]];
+            return (positions & cls.stay) | ((positions & cls.advance) << 1);
+        }
 
         struct Part
         {
             Wildcard wildcard = Wildcard::Nothing;
+            // Can contain '?' and bracket expressions
             std::string str;
+            // Number of bytes matched by str
+            std::size_t size = 0;
+            // Set when str only contains literal characters that are matched case-sensitively
+            bool literal = true;
+            // Set of bytes per matched byte, only used when !literal
+            std::vector<ByteSet> sets;
+            // Searches str, also case-insensitively. Empty when str contains '?' or bracket expressions.
+            strng::Needle needle;
         };
+        Config config_;
         std::vector<Part> parts_;
+        Kind kind_ = Kind::Generic;
+        // Longest part with a needle, which must occur in any match. Used to reject most strings before running the NFA.
+        std::size_t required_ix_ = -1;
+
+        // Bytes that behave the same share a class: 0 is used for bytes that do not occur in the pattern and 1 for '/'
+        struct ByteClass
+        {
+            // Positions that match this byte, which advance to the next position
+            std::uint64_t advance = 0;
+            // Positions with a wildcard that can consume this byte
+            std::uint64_t stay = 0;
+        };
+        std::array<std::uint8_t, 256> byte_classes_{};
+        std::vector<ByteClass> classes_;
+        // Final position, 0 when the pattern is too long for the NFA
+        std::uint64_t last_bit_ = 0;
+        bool last_all_ = false;
     };
 
 } // namespace rubr::glob
@@ -0,0 +1,211 @@
+#include <rubr/debug/log.hpp>
+#include <rubr/glob/GlobSet.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+
+namespace rubr::glob {
+
+    void GlobSet::clear()
+    {
+        globs_.clear();
+        build();
+    }
+
+    void GlobSet::add(const Glob &glob)
+    {
+        globs_.push_back(&glob);
+    }
+
+    void GlobSet::add_(std::vector<Bucket> &buckets, const std::string &literal, std::uint32_t ix)
+    {
+        auto it = std::find_if(buckets.begin(), buckets.end(), [&](const auto &bucket) { return bucket.size == literal.size(); });
+        if (it == buckets.end())
+        {
+            buckets.emplace_back();
+            it = buckets.end() - 1;
+            it->size = literal.size();
+        }
+        // Later globs have a higher priority
+        it->ixs[literal] = ix;
+    }
+
+    void GlobSet::build()
+    {
+        S(nullptr);
+
+        exacts_.clear();
+        prefixes_.clear();
+        suffixes_.clear();
+        nodes_.assign(1, Node{});
+        always_.clear();
+
+        for (std::uint32_t ix = 0; ix < globs_.size(); ++ix)
+        {
+            const auto &glob = *globs_[ix];
+            const auto &parts = glob.parts_;
+            const auto &first = parts.front();
+            const auto &last = parts.back();
+            // Some-wildcards need a check beyond the literal, these are verified via Aho-Corasick
+            switch (glob.kind())
+            {
+                case Glob::Kind::Exact: add_(exacts_, first.str, ix); continue;
+                case Glob::Kind::Suffix:
+                    if (first.wildcard == Wildcard::All)
+                    {
+                        add_(suffixes_, first.str, ix);
+                        continue;
+                    }
+                    break;
+                case Glob::Kind::Prefix:
+                    if (last.wildcard == Wildcard::All)
+                    {
+                        add_(prefixes_, first.str, ix);
+                        continue;
+                    }
+                    break;
+                default: break;
+            }
+
+            // Parts with '?', bracket expressions or that ignore case cannot be searched for as is
+            const Glob::Part *longest = nullptr;
+            for (const auto &part : parts)
+            {
+                if (part.literal && (!longest || part.str.size() > longest->str.size()))
+                    longest = &part;
+            }
+            if (!longest || longest->str.empty())
+            {
+                always_.push_back(ix);
+                continue;
+            }
+
+            std::uint32_t node_ix = 0;
+            for (const std::uint8_t byte : longest->str)
+            {
+                auto child_ix = child_(node_ix, byte);
+                if (!child_ix)
+                {
+                    child_ix = nodes_.size();
+                    auto &next = nodes_[node_ix].next;
+                    next.insert(std::lower_bound(next.begin(), next.end(), std::pair<std::uint8_t, std::uint32_t>{byte, 0}), {byte, child_ix});
+                    nodes_.emplace_back();
+                }
+                node_ix = child_ix;
+            }
+            nodes_[node_ix].ixs.push_back(ix);
+        }
+
+        std::reverse(always_.begin(), always_.end());
+
+        // Breadth-first construction of the fail and output links
+        std::deque<std::uint32_t> todo;
+        for (const auto &[byte, child_ix] : nodes_[0].next)
+            todo.push_back(child_ix);
+        while (!todo.empty())
+        {
+            const auto node_ix = todo.front();
+            todo.pop_front();
+
+            auto &node = nodes_[node_ix];
+            std::sort(node.ixs.begin(), node.ixs.end(), std::greater<>{});
+            const auto &fail = nodes_[node.fail];
+            node.output = !fail.ixs.empty() ? node.fail : fail.output;
+
+            for (const auto &[byte, child_ix] : node.next)
+            {
+                std::uint32_t fail_ix = node.fail;
+                while (fail_ix && !child_(fail_ix, byte))
+                    fail_ix = nodes_[fail_ix].fail;
+                const auto fail_child_ix = child_(fail_ix, byte);
+                nodes_[child_ix].fail = fail_child_ix != child_ix ? fail_child_ix : 0;
+                todo.push_back(child_ix);
+            }
+        }
+
+        L(C(globs_.size()) C(exacts_.size()) C(prefixes_.size()) C(suffixes_.size()) C(nodes_.size()) C(always_.size()));
+    }
+
+    std::uint32_t GlobSet::child_(std::uint32_t node_ix, std::uint8_t byte) const
+    {
+        const auto &next = nodes_[node_ix].next;
+        const auto it = std::lower_bound(next.begin(), next.end(), byte, [](const auto &p, std::uint8_t byte) { return p.first < byte; });
+        return it != next.end() && it->first == byte ? it->second : 0;
+    }
+
+    void GlobSet::verify_(std::uint32_t node_ix, const std::string_view &str, std::size_t name, std::size_t &best) const
+    {
+        for (const auto ix : nodes_[node_ix].ixs)
+        {
+            if (best != npos && ix <= best)
+                // ixs is sorted from high to low
+                break;
+            if ((*globs_[ix])(str, name))
+            {
+                best = ix;
+                break;
+            }
+        }
+    }
+
+    std::size_t GlobSet::match(const std::string_view &str, std::size_t name) const
+    {
+        std::size_t best = npos;
+        auto update = [&](std::uint32_t ix) {
+            if (best == npos || ix > best)
+                best = ix;
+        };
+
+        for (const auto &bucket : exacts_)
+        {
+            if (bucket.size != str.size())
+                continue;
+            if (const auto it = bucket.ixs.find(str); it != bucket.ixs.end())
+                update(it->second);
+        }
+        for (const auto &bucket : prefixes_)
+        {
+            if (bucket.size > str.size())
+                continue;
+            if (const auto it = bucket.ixs.find(str.substr(0, bucket.size)); it != bucket.ixs.end())
+                update(it->second);
+        }
+        for (const auto &bucket : suffixes_)
+        {
+            if (bucket.size > str.size())
+                continue;
+            if (const auto it = bucket.ixs.find(str.substr(str.size() - bucket.size)); it != bucket.ixs.end())
+                update(it->second);
+        }
+
+        for (const auto ix : always_)
+        {
+            if (best != npos && ix <= best)
+                break;
+            if ((*globs_[ix])(str, name))
+            {
+                best = ix;
+                break;
+            }
+        }
+
+        if (nodes_.size() > 1)
+        {
+            std::uint32_t node_ix = 0;
+            for (const std::uint8_t byte : str)
+            {
+                std::uint32_t child_ix;
+                while (!(child_ix = child_(node_ix, byte)) && node_ix)
+                    node_ix = nodes_[node_ix].fail;
+                node_ix = child_ix;
+
+                for (auto out_ix = nodes_[node_ix].ixs.empty() ? nodes_[node_ix].output : node_ix; out_ix; out_ix = nodes_[out_ix].output)
+                    verify_(out_ix, str, name, best);
+            }
+        }
+
+        return best;
+    }
+
+} // namespace rubr::glob
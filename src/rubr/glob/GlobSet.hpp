@@ -0,0 +1,77 @@
+#ifndef HEADER_rubr_glob_GlobSet_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_glob_GlobSet_hpp_ALREADY_INCLUDED
+
+#include <rubr/glob/Glob.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rubr::glob {
+
+    // Matches a path against many globs at once and returns the one with the highest priority, which is its index.
+    // - Exact, prefix and suffix patterns are looked up in hash tables, one per literal size.
+    // - For other patterns, the longest literal part is searched for with Aho-Corasick, and only the patterns
+    //   with a literal that occurs in the path are verified with their Glob. Patterns without a part that is
+    //   matched literally are always verified.
+    // The globs are referenced, not copied: they must outlive the GlobSet.
+    class GlobSet
+    {
+    public:
+        static constexpr std::size_t npos = -1;
+
+        void clear();
+        void add(const Glob &glob);
+        // Compiles all added globs, must be called before match()
+        void build();
+
+        std::size_t size() const { return globs_.size(); }
+
+        // Index of the last added glob that matches str, or npos. name is passed to Glob::operator().
+        std::size_t match(const std::string_view &str, std::size_t name = Glob::npos) const;
+
+    private:
+        struct Hash
+        {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view sv) const { return std::hash<std::string_view>{}(sv); }
+        };
+        // Highest index per literal of a given size
+        struct Bucket
+        {
+            std::size_t size = 0;
+            std::unordered_map<std::string, std::uint32_t, Hash, std::equal_to<>> ixs;
+        };
+        static void add_(std::vector<Bucket> &buckets, const std::string &literal, std::uint32_t ix);
+
+        // Aho-Corasick automaton over the required literals
+        struct Node
+        {
+            // Sorted on byte
+            std::vector<std::pair<std::uint8_t, std::uint32_t>> next;
+            std::uint32_t fail = 0;
+            // Closest node via fail links that has patterns, 0 if none
+            std::uint32_t output = 0;
+            // Sorted from high to low
+            std::vector<std::uint32_t> ixs;
+        };
+        std::uint32_t child_(std::uint32_t node_ix, std::uint8_t byte) const;
+        // Verifies the patterns of node_ix and updates best
+        void verify_(std::uint32_t node_ix, const std::string_view &str, std::size_t name, std::size_t &best) const;
+
+        std::vector<const Glob *> globs_;
+        std::vector<Bucket> exacts_;
+        std::vector<Bucket> prefixes_;
+        std::vector<Bucket> suffixes_;
+        std::vector<Node> nodes_;
+        // Patterns without any literal, they are always verified. Sorted from high to low.
+        std::vector<std::uint32_t> always_;
+    };
+
+} // namespace rubr::glob
+
+#endif
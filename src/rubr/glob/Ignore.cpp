@@ -1,28 +1,62 @@
 #include <rubr/glob/Ignore.hpp>
 
-#include <rubr/fs/util.hpp>
+#include <rubr/fs/MappedFile.hpp>
+#include <rubr/glob/Intern.hpp>
 #include <rubr/mss.hpp>
 #include <rubr/parse/Strange.hpp>
+#include <rubr/strng/CharSet.hpp>
+#include <rubr/strng/append.hpp>
+
+#include <atomic>
 
 namespace rubr::glob {
 
+    namespace {
+        // Above this, a batch is matched per fp with the GlobSet
+        constexpr std::size_t c_max_batch_rules = 32;
+
+        std::atomic<std::uint64_t> s_next_id{1};
+
+        // A leading All-wildcard followed by a pattern without '/' can only match within the last path component
+        bool is_name_only(const Glob &glob)
+        {
+            // A '**' after the front can match across a '/', which makes the decision depend on the folders as well
+            const auto &config = glob.config();
+            return config.front == Wildcard::All && glob.all_only_in_front() && !config.pattern.contains('/');
+        }
+    } // namespace
+
+    void Ignore::build_()
+    {
+        set_.clear();
+        name_only_ = true;
+        for (const auto &rule : rules_)
+        {
+            set_.add(*rule.glob);
+            name_only_ = name_only_ && is_name_only(*rule.glob);
+        }
+        set_.build();
+        id_ = s_next_id++;
+    }
+
     bool Ignore::load_from_file(const std::filesystem::path &fp)
     {
         MSS_BEGIN(bool);
-        std::string content;
-        MSS(rubr::fs::read(content, fp));
-        MSS(load_from_content(content));
+        rubr::fs::MappedFile file;
+        MSS(file.open(fp));
+        MSS(load_from_content(file.content()));
         MSS_END();
     }
 
-    bool Ignore::load_from_content(const std::string &content)
+    bool Ignore::load_from_content(std::string_view content)
     {
         MSS_BEGIN(bool);
-        L(C(this)C(ignores_.size()) C(includes_.size()));
+        L(C(this)C(rules_.size()));
 
-        const std::string whitespace = " ";
+        const rubr::strng::CharSet whitespace{" "};
+        auto &intern = Intern::global();
 
-        rubr::parse::Strange strange(content);
+        rubr::parse::Strange strange(content.data(), content.size());
         for (rubr::parse::Strange line; strange.pop_line(line);)
         {
             L(C(line.str()));
@@ -32,55 +66,102 @@ namespace rubr::glob {
             if (line.pop_if('#'))
                 continue;
 
-            auto &dst = line.pop_if('!') ? includes_ : ignores_;
+            const bool include = line.pop_if('!');
 
             if (line.empty())
                 continue;
 
-            rubr::glob::Glob::Config config;
-            config.front = line.pop_if('/') ? rubr::glob::Wildcard::Nothing : rubr::glob::Wildcard::All;
-            config.pattern = line.str();
-            config.back = line.back() == '/' ? rubr::glob::Wildcard::All : rubr::glob::Wildcard::Nothing;
+            const auto front = line.pop_if('/') ? rubr::glob::Wildcard::Nothing : rubr::glob::Wildcard::All;
+            const auto back = line.back() == '/' ? rubr::glob::Wildcard::All : rubr::glob::Wildcard::Nothing;
 
-            dst.emplace_back(config);
+            rules_.push_back(Rule{.glob = &intern(front, line.view(), back), .include = include});
         }
 
-        L(C(this)C(ignores_.size()) C(includes_.size()));
+        build_();
+
+        L(C(this)C(rules_.size()));
 
         MSS_END();
     }
 
-    bool Ignore::operator()(const std::string_view &fp) const
+    void Ignore::write(std::string &dst) const
     {
-        S(nullptr);
-        L(C(this)C(ignores_.size()) C(includes_.size()));
+        strng::append_lsb(dst, (std::uint32_t)rules_.size());
+        std::string glob;
+        for (const auto &rule : rules_)
+        {
+            strng::append_lsb(dst, (std::uint8_t)rule.include);
+            glob.clear();
+            rule.glob->write(glob);
+            strng::append_sized<std::uint32_t>(dst, glob);
+        }
+    }
+
+    bool Ignore::read(rubr::parse::Strange &src)
+    {
+        MSS_BEGIN(bool);
+
+        std::uint32_t count;
+        MSS(src.pop_lsb(count));
+        // Each rule takes at least 5 bytes
+        MSS(count <= src.size() / 5);
+        std::vector<Rule> rules;
+        rules.reserve(count);
+        auto &intern = Intern::global();
+        for (std::uint32_t ix = 0; ix < count; ++ix)
+        {
+            std::uint8_t include;
+            MSS(src.pop_lsb(include));
+            const Glob *glob = nullptr;
+            MSS(intern.read(glob, src));
+            rules.push_back(Rule{.glob = glob, .include = !!include});
+        }
+        rules_ = std::move(rules);
+        build_();
 
-        bool do_ignore = false;
+        MSS_END();
+    }
+
+    void Ignore::operator()(std::span<const std::string_view> fps, Mask &mask) const
+    {
+        mask.assign((fps.size() + 63) / 64, 0);
 
-        for (const auto &ignore_glob : ignores_)
+        if (rules_.size() > c_max_batch_rules)
         {
-            L(C(&ignore_glob));
-            if (ignore_glob(fp))
-            {
-                do_ignore = true;
-                break;
-            }
+            for (std::size_t ix = 0; ix < fps.size(); ++ix)
+                mask[ix / 64] |= std::uint64_t{(*this)(fps[ix])} << (ix % 64);
+            return;
         }
 
-        if (do_ignore)
+        // The fps that are not matched by a later rule yet
+        Mask undecided(mask.size(), ~std::uint64_t{0});
+        if (fps.size() % 64)
+            undecided.back() = (std::uint64_t{1} << (fps.size() % 64)) - 1;
+
+        Mask matches;
+        for (auto it = rules_.rbegin(); it != rules_.rend(); ++it)
         {
-            for (const auto &include_glob : includes_)
+            (*it->glob)(fps, matches);
+            std::uint64_t any = 0;
+            for (std::size_t word = 0; word < mask.size(); ++word)
             {
-                L(C(&include_glob));
-                if (include_glob(fp))
-                {
-                    do_ignore = false;
-                    break;
-                }
+                const auto decided = matches[word] & undecided[word];
+                if (!it->include)
+                    mask[word] |= decided;
+                undecided[word] &= ~decided;
+                any |= undecided[word];
             }
+            if (!any)
+                break;
         }
+    }
 
-        return do_ignore;
+    const Ignore::Rule *Ignore::match(const std::string_view &fp, std::size_t name) const
+    {
+        S(nullptr);
+        const auto ix = set_.match(fp, name);
+        L(C(this)C(fp) C(ix));
+        return ix != GlobSet::npos ? &rules_[ix] : nullptr;
     }
 
 } // namespace rubr::glob
@@ -2,24 +2,67 @@
 #define HEADER_rubr_glob_Ignore_hpp_ALREADY_INCLUDED
 
 #include <rubr/glob/Glob.hpp>
+#include <rubr/glob/GlobSet.hpp>
 
+#include <rubr/parse/Strange.hpp>
+
+#include <cstdint>
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace rubr::glob {
 
+    // The compiled globs are shared via Intern::global(), which makes an Ignore cheap to load and copy
     class Ignore
     {
     public:
+        // Maps the file instead of reading it into a std::string
         bool load_from_file(const std::filesystem::path &fp);
-        bool load_from_content(const std::string &content);
+        bool load_from_content(std::string_view content);
+
+        // Binary serialization of the parsed rules, for use in caches and indices
+        void write(std::string &dst) const;
+        bool read(rubr::parse::Strange &src);
+
+        struct Rule
+        {
+            // Owned by Intern::global()
+            const Glob *glob = nullptr;
+            // Set for '!'-rules
+            bool include = false;
+        };
+        const std::vector<Rule> &rules() const { return rules_; }
 
-        bool operator()(const std::string_view &fp) const;
+        // Changes each time rules are loaded or read, and is shared by copies. 0 when nothing was loaded yet.
+        std::uint64_t id() const { return id_; }
+        // Set when no rule looks beyond the last path component, e.g. `*.o` or `build`, but not `build/` or `/build`:
+        // the decision for a path is then the same as for its name.
+        bool name_only() const { return name_only_; }
+
+        // Rules are evaluated as git does: the last rule that matches fp decides, '!'-rules re-include.
+        // name is the offset of the last path component in fp, when known.
+        bool operator()(const std::string_view &fp, std::size_t name = Glob::npos) const
+        {
+            const auto rule = match(fp, name);
+            return rule && !rule->include;
+        }
+        // Sets the bit of each of fps that is ignored. For a small number of rules, each rule is matched
+        // against all remaining fps at once, else each fp is matched against all rules at once.
+        void operator()(std::span<const std::string_view> fps, Mask &mask) const;
+        // The last rule that matches fp, or nullptr
+        const Rule *match(const std::string_view &fp, std::size_t name = Glob::npos) const;
 
     private:
-        std::vector<Glob> ignores_;
-        std::vector<Glob> includes_;
+        void build_();
+
+        // In the order of the file
+        std::vector<Rule> rules_;
+        // Refers to the globs of rules_
+        GlobSet set_;
+        std::uint64_t id_ = 0;
+        bool name_only_ = true;
     };
 
 } // namespace rubr::glob
@@ -0,0 +1,147 @@
+#include <rubr/glob/IgnoreCache.hpp>
+
+#include <rubr/fs/Index.hpp>
+#include <rubr/mss.hpp>
+#include <rubr/parse/Strange.hpp>
+#include <rubr/strng/append.hpp>
+
+#include <fstream>
+
+namespace rubr::glob {
+
+    namespace {
+        // Bump the version when the format changes
+        constexpr std::string_view c_magic = "rubrIC01";
+    } // namespace
+
+    bool IgnoreCache::load(const std::filesystem::path &fp)
+    {
+        MSS_BEGIN(bool);
+
+        file_.close();
+        entries_.clear();
+
+        if (!file_.open(fp))
+            // No cache yet
+            MSS_RETURN_OK();
+
+        const auto content = file_.content();
+        rubr::parse::Strange strange{content.data(), content.size()};
+        auto parse = [&]() {
+            std::uint64_t count;
+            if (!strange.pop_if(std::string{c_magic}) || !strange.pop_lsb(count))
+                return false;
+            for (std::uint64_t ix = 0; ix < count; ++ix)
+            {
+                std::uint16_t path_size;
+                rubr::parse::Strange path;
+                Entry entry;
+                std::uint32_t ignore_size;
+                rubr::parse::Strange ignore;
+                if (!strange.pop_lsb(path_size) || !strange.pop_count(path, path_size))
+                    return false;
+                if (!strange.pop_lsb(entry.check.ino) || !strange.pop_lsb(entry.check.size) || !strange.pop_lsb(entry.check.mtime_ns) || !strange.pop_lsb(entry.check.ctime_ns))
+                    return false;
+                if (!strange.pop_lsb(ignore_size) || !strange.pop_count(ignore, ignore_size))
+                    return false;
+                entry.ignore = ignore.view();
+                entries_[path.view()] = entry;
+            }
+            return strange.empty();
+        };
+        if (!parse())
+        {
+            L("Ignoring invalid ignore cache " << fp);
+            entries_.clear();
+            file_.close();
+        }
+
+        MSS_END();
+    }
+
+    bool IgnoreCache::load_ignore(Ignore &ignore, const std::filesystem::path &fp)
+    {
+        MSS_BEGIN(bool);
+
+        const auto &path = fp.native();
+
+        rubr::fs::Index::Stat stat;
+        if (!rubr::fs::Index::stat(stat, path.c_str()))
+        {
+            // Cannot be cached, load_from_file() reports the error, if any
+            ++miss_count_;
+            Ignore loaded;
+            MSS(loaded.load_from_file(fp));
+            ignore = std::move(loaded);
+            MSS_RETURN_OK();
+        }
+        const Check check{.ino = stat.key.ino, .size = stat.size, .mtime_ns = stat.mtime_ns, .ctime_ns = stat.ctime_ns};
+
+        std::string blob;
+        if (const auto it = entries_.find(path); it != entries_.end() && it->second.check == check)
+        {
+            rubr::parse::Strange strange{it->second.ignore.data(), it->second.ignore.size()};
+            Ignore cached;
+            if (cached.read(strange) && strange.empty())
+            {
+                ++hit_count_;
+                ignore = std::move(cached);
+                blob = it->second.ignore;
+            }
+            else
+            {
+                L("Could not read cached ignore rules for " << fp);
+            }
+        }
+
+        if (blob.empty())
+        {
+            // Into a fresh Ignore, as a hit does: load_from_file() appends to the existing rules
+            ++miss_count_;
+            Ignore loaded;
+            MSS(loaded.load_from_file(fp));
+            loaded.write(blob);
+            ignore = std::move(loaded);
+        }
+
+        std::lock_guard<std::mutex> lock{mutex_};
+        added_[path] = std::make_pair(check, std::move(blob));
+
+        MSS_END();
+    }
+
+    bool IgnoreCache::save(const std::filesystem::path &fp) const
+    {
+        MSS_BEGIN(bool);
+
+        std::string content{c_magic};
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            strng::append_lsb(content, (std::uint64_t)added_.size());
+            for (const auto &[path, entry] : added_)
+            {
+                const auto &[check, blob] = entry;
+                strng::append_sized<std::uint16_t>(content, path);
+                for (const auto v : {check.ino, check.size, check.mtime_ns, check.ctime_ns})
+                    strng::append_lsb(content, v);
+                strng::append_sized<std::uint32_t>(content, blob);
+            }
+        }
+
+        auto tmp_fp = fp;
+        tmp_fp += ".tmp";
+        {
+            std::ofstream fo{tmp_fp, std::ios::binary | std::ios::trunc};
+            MSS(fo.good());
+            fo.write(content.data(), content.size());
+            MSS(fo.good());
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmp_fp, fp, ec);
+        MSS(!ec);
+
+        MSS_END();
+    }
+
+} // namespace rubr::glob
@@ -0,0 +1,69 @@
+#ifndef HEADER_rubr_glob_IgnoreCache_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_glob_IgnoreCache_hpp_ALREADY_INCLUDED
+
+#include <rubr/fs/MappedFile.hpp>
+#include <rubr/glob/Ignore.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace rubr::glob {
+
+    // Persistent, memory-mapped cache of compiled ignore files, keyed by their path.
+    // An entry is only used when the inode, size, mtime and ctime of the ignore file did not change. It holds
+    // the output of Ignore::write(), including the compiled Globs: a hit neither parses the ignore file nor
+    // splits or compiles its patterns.
+    class IgnoreCache
+    {
+    public:
+        // Maps an existing cache file. A missing or invalid file results in an empty cache.
+        bool load(const std::filesystem::path &fp);
+
+        // Replaces the rules of ignore with those of the ignore file fp, from the cache when fp did not change.
+        // The result is added to be written by save(). Can be called concurrently.
+        bool load_ignore(Ignore &ignore, const std::filesystem::path &fp);
+
+        // Writes all entries that were used via load_ignore(), replacing the file atomically
+        bool save(const std::filesystem::path &fp) const;
+
+        std::size_t hit_count() const { return hit_count_; }
+        std::size_t miss_count() const { return miss_count_; }
+
+    private:
+        struct Check
+        {
+            std::uint64_t ino = 0;
+            std::uint64_t size = 0;
+            std::uint64_t mtime_ns = 0;
+            std::uint64_t ctime_ns = 0;
+
+            bool operator==(const Check &) const = default;
+        };
+        struct Entry
+        {
+            Check check;
+            // Points into file_
+            std::string_view ignore;
+        };
+
+        rubr::fs::MappedFile file_;
+        // Keys point into file_
+        std::unordered_map<std::string_view, Entry> entries_;
+
+        std::atomic<std::size_t> hit_count_{0};
+        std::atomic<std::size_t> miss_count_{0};
+
+        mutable std::mutex mutex_;
+        std::map<std::string, std::pair<Check, std::string>> added_;
+    };
+
+} // namespace rubr::glob
+
+#endif
@@ -0,0 +1,68 @@
+#include <rubr/debug/log.hpp>
+#include <rubr/glob/DecisionCache.hpp>
+#include <rubr/glob/IgnoreStack.hpp>
+
+namespace rubr::glob {
+
+    void IgnoreStack::push(const Ignore &ignore, std::size_t base)
+    {
+        if (!ignore.rules().empty())
+            levels_.push_back(Level{.ignore = &ignore, .base = base});
+    }
+
+    bool IgnoreStack::operator()(const std::string_view &path, std::size_t name, DecisionCache *cache) const
+    {
+        S(nullptr);
+
+        for (auto it = levels_.rbegin(); it != levels_.rend(); ++it)
+        {
+            const auto relpath = path.substr(it->base);
+            const auto relname = name != Glob::npos && name >= it->base ? name - it->base : Glob::npos;
+            const auto &ignore = *it->ignore;
+            const auto rule = cache && ignore.name_only() ? cache->match(ignore, relpath, relname) : ignore.match(relpath, relname);
+            if (rule)
+            {
+                L(C(relpath) C(rule->include));
+                return !rule->include;
+            }
+        }
+
+        return false;
+    }
+
+    Below IgnoreStack::below(const std::string_view &path) const
+    {
+        S(nullptr);
+
+        bool may_include = false;
+        bool may_ignore = false;
+        for (auto level = levels_.rbegin(); level != levels_.rend(); ++level)
+        {
+            // The folder of a level itself has no relative path
+            const auto reldir = level->base <= path.size() ? path.substr(level->base) : std::string_view{};
+            const auto &rules = level->ignore->rules();
+            for (auto it = rules.rbegin(); it != rules.rend(); ++it)
+            {
+                const auto below = it->glob->below(reldir);
+                L(C(reldir) C(it->include) C(below, int));
+                if (below == Below::None)
+                    continue;
+
+                if (it->include)
+                {
+                    may_include = true;
+                }
+                else
+                {
+                    // Only rules with a higher priority can overrule this one
+                    if (below == Below::All && !may_include)
+                        return Below::All;
+                    may_ignore = true;
+                }
+            }
+        }
+
+        return may_ignore ? Below::Some : Below::None;
+    }
+
+} // namespace rubr::glob
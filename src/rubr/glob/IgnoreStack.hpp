@@ -0,0 +1,49 @@
+#ifndef HEADER_rubr_glob_IgnoreStack_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_glob_IgnoreStack_hpp_ALREADY_INCLUDED
+
+#include <rubr/glob/Ignore.hpp>
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace rubr::glob {
+
+    class DecisionCache;
+
+    // Rules of nested Ignores. As git does, the rules of a deeper level take precedence over those of its parents,
+    // and within a level, the last matching rule wins. Each level matches all its rules at once with its GlobSet.
+    // The Ignores are referenced, not copied: they must outlive the IgnoreStack.
+    class IgnoreStack
+    {
+    public:
+        // Adds the rules of a deeper level. They are applied to the part of a path starting at base.
+        void push(const Ignore &ignore, std::size_t base);
+
+        // path must be below the folder of each level that was pushed.
+        // name is the offset of the last path component in path, when known.
+        // When cache is given, it is used for the levels with an Ignore::name_only() Ignore: other levels
+        // depend on the complete path, which is typically tested only once.
+        bool operator()(const std::string_view &path, std::size_t name = Glob::npos, DecisionCache *cache = nullptr) const;
+
+        // Static analysis of the paths below the folder at path, which must be the folder of a level or below it:
+        // - None: no path below it can be ignored, matching can be switched off.
+        // - All: every path below it is ignored, it does not have to be opened. As git does not descend into
+        //   an excluded folder, a '.gitignore' below it cannot re-include anything.
+        Below below(const std::string_view &path) const;
+
+        bool empty() const { return levels_.empty(); }
+
+    private:
+        struct Level
+        {
+            const Ignore *ignore = nullptr;
+            std::size_t base = 0;
+        };
+        // From the outermost to the innermost level
+        std::vector<Level> levels_;
+    };
+
+} // namespace rubr::glob
+
+#endif
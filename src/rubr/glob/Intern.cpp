@@ -0,0 +1,88 @@
+#include <rubr/glob/Intern.hpp>
+#include <rubr/mss.hpp>
+
+#include <functional>
+
+namespace rubr::glob {
+
+    Intern &Intern::global()
+    {
+        static Intern intern;
+        return intern;
+    }
+
+    std::size_t Intern::Hash::operator()(const Key &key) const
+    {
+        const std::size_t flags = (std::size_t(key.front) << 3) | (std::size_t(key.back) << 1) | std::size_t(key.ignore_case);
+        return std::hash<std::string_view>{}(key.pattern) ^ (flags * 0x9e3779b97f4a7c15ull);
+    }
+
+    const Glob &Intern::operator()(const Glob::Config &config)
+    {
+        return (*this)(config.front, config.pattern, config.back, config.ignore_case);
+    }
+
+    const Glob &Intern::operator()(Wildcard front, std::string_view pattern, Wildcard back, bool ignore_case)
+    {
+        const Key key{.front = front, .pattern = pattern, .back = back, .ignore_case = ignore_case};
+        if (const auto *glob = find_(key))
+            return *glob;
+
+        // Compiled without holding mutex_, other threads can continue meanwhile
+        return insert_(key, Glob{Glob::Config{.front = front, .pattern = std::string(pattern), .back = back, .ignore_case = ignore_case}});
+    }
+
+    bool Intern::read(const Glob *&glob, rubr::parse::Strange &src)
+    {
+        MSS_BEGIN(bool);
+
+        std::uint32_t size;
+        rubr::parse::Strange blob;
+        MSS(src.pop_lsb(size));
+        MSS(src.pop_count(blob, size));
+
+        auto header_src = blob;
+        Glob::Header header;
+        MSS(Glob::read_header(header, header_src));
+        const Key key{.front = header.front, .pattern = header.pattern, .back = header.back, .ignore_case = header.ignore_case};
+
+        glob = find_(key);
+        if (!glob)
+        {
+            Glob new_glob;
+            MSS(new_glob.read(blob));
+            glob = &insert_(key, std::move(new_glob));
+        }
+
+        MSS_END();
+    }
+
+    const Glob *Intern::find_(const Key &key) const
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        const auto it = lookup_.find(key);
+        return it == lookup_.end() ? nullptr : it->second;
+    }
+
+    const Glob &Intern::insert_(const Key &key, Glob &&glob)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        // Another thread might have added it in the meantime
+        if (const auto it = lookup_.find(key); it != lookup_.end())
+            return *it->second;
+
+        const auto &stored_glob = globs_.emplace_back(std::move(glob));
+        auto stored = key;
+        stored.pattern = stored_glob.config().pattern;
+        lookup_.emplace(stored, &stored_glob);
+        return stored_glob;
+    }
+
+    std::size_t Intern::size() const
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return globs_.size();
+    }
+
+} // namespace rubr::glob
@@ -0,0 +1,60 @@
+#ifndef HEADER_rubr_glob_Intern_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_glob_Intern_hpp_ALREADY_INCLUDED
+
+#include <rubr/glob/Glob.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace rubr::glob {
+
+    // Table of compiled globs where identical configs share a single Glob. A tree with many '.gitignore' files
+    // typically contains only a few hundred distinct patterns, each is split and compiled only once.
+    // Globs are never removed: references stay valid for the lifetime of the Intern. Thread-safe.
+    class Intern
+    {
+    public:
+        // The process-wide instance, used by Ignore
+        static Intern &global();
+
+        const Glob &operator()(const Glob::Config &config);
+        const Glob &operator()(Wildcard front, std::string_view pattern, Wildcard back, bool ignore_case = false);
+        // Reads the output of Glob::write(), prefixed with its u32 size. The compiled glob is only
+        // deserialized when it is not present yet.
+        bool read(const Glob *&glob, rubr::parse::Strange &src);
+
+        // Number of distinct globs
+        std::size_t size() const;
+
+    private:
+        struct Key
+        {
+            Wildcard front = Wildcard::Nothing;
+            // Refers to the pattern of the Glob in globs_
+            std::string_view pattern;
+            Wildcard back = Wildcard::Nothing;
+            bool ignore_case = false;
+
+            bool operator==(const Key &) const = default;
+        };
+        struct Hash
+        {
+            std::size_t operator()(const Key &key) const;
+        };
+
+        const Glob *find_(const Key &key) const;
+        // Keeps the Glob that is already present for key, if any
+        const Glob &insert_(const Key &key, Glob &&glob);
+
+        mutable std::mutex mutex_;
+        // Stable addresses
+        std::deque<Glob> globs_;
+        std::unordered_map<Key, const Glob *, Hash> lookup_;
+    };
+
+} // namespace rubr::glob
+
+#endif
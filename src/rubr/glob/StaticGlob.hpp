@@ -0,0 +1,182 @@
+#ifndef HEADER_rubr_glob_StaticGlob_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_glob_StaticGlob_hpp_ALREADY_INCLUDED
+
+#include <rubr/glob/Glob.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace rubr::glob {
+
+    // String literal that can be used as template argument
+    template<std::size_t N>
+    struct FixedString
+    {
+        char data[N]{};
+
+        constexpr FixedString(const char (&str)[N]) { std::copy_n(str, N, data); }
+
+        constexpr std::string_view view() const { return std::string_view{data, N - 1}; }
+    };
+
+    // Glob with a pattern that is known at compile time, e.g. `StaticGlob<"**/*.cpp">`.
+    // The pattern is split and compiled into a Shift-And NFA by the compiler: matching does not allocate,
+    // and patterns with a single literal part reduce to starts_with()/ends_with()/==. '?' and bracket
+    // expressions are supported, matching is always case-sensitive.
+    // Matches exactly the same strings as Glob{{.front = Front, .pattern = Pattern, .back = Back}}.
+    template<FixedString Pattern, Wildcard Front = Wildcard::Nothing, Wildcard Back = Wildcard::Nothing>
+    class StaticGlob
+    {
+    public:
+        static constexpr std::string_view pattern() { return Pattern.view(); }
+
+        constexpr bool operator()(std::string_view str) const
+        {
+            constexpr const Part &first = c_parts.front();
+            constexpr const Part &last = c_parts.back();
+
+            if constexpr (c_parts.size() == 1)
+            {
+                // Pattern without literal
+                return match_(last.wildcard, str);
+            }
+            else if constexpr (c_parts.size() == 2 && first.literal && last.wildcard == Wildcard::Nothing)
+            {
+                // Exact match, or a single wildcard followed by a suffix
+                return str.ends_with(first.str()) && match_(first.wildcard, str.substr(0, str.size() - first.size));
+            }
+            else if constexpr (c_parts.size() == 2 && first.literal && first.wildcard == Wildcard::Nothing)
+            {
+                // Prefix followed by a single wildcard
+                return str.starts_with(first.str()) && match_(last.wildcard, str.substr(first.size));
+            }
+            else
+            {
+                static_assert(c_position_count <= 64, "StaticGlob supports patterns with at most 63 literal characters, use Glob instead");
+
+                // Cheap rejection on an anchored first or last literal before running the NFA
+                if constexpr (first.literal && first.wildcard == Wildcard::Nothing)
+                {
+                    if (!str.starts_with(first.str()))
+                        return false;
+                }
+                if constexpr (c_parts[c_parts.size() - 2].literal && last.wildcard == Wildcard::Nothing)
+                {
+                    if (!str.ends_with(c_parts[c_parts.size() - 2].str()))
+                        return false;
+                }
+
+                std::uint64_t positions = 1;
+                for (const auto ch : str)
+                {
+                    const auto byte = (std::uint8_t)ch;
+                    const auto stay = byte == '/' ? c_nfa.all : (c_nfa.some | c_nfa.all);
+                    positions = (positions & stay) | ((positions & c_nfa.advance[byte]) << 1);
+                    if (!positions)
+                        return false;
+                }
+                return positions & c_nfa.last;
+            }
+        }
+
+    private:
+        struct Part
+        {
+            Wildcard wildcard = Wildcard::Nothing;
+            // Location in Pattern
+            std::size_t begin = 0;
+            std::size_t length = 0;
+            // Number of bytes matched
+            std::size_t size = 0;
+            // Without '?' or bracket expressions
+            bool literal = true;
+
+            constexpr std::string_view str() const { return Pattern.view().substr(begin, length); }
+        };
+
+        static constexpr bool match_(Wildcard wildcard, std::string_view sv)
+        {
+            switch (wildcard)
+            {
+                case Wildcard::Nothing: return sv.empty();
+                case Wildcard::Some: return sv.find('/') == std::string_view::npos;
+                case Wildcard::All: return true;
+            }
+            return false;
+        }
+
+        static constexpr std::size_t c_part_count = [] {
+            std::size_t count = 0;
+            split(Front, Pattern.view(), Back, [&](Wildcard, std::string_view) { ++count; });
+            return count;
+        }();
+
+        static constexpr std::array<Part, c_part_count> c_parts = [] {
+            std::array<Part, c_part_count> parts{};
+            std::size_t ix = 0;
+            split(Front, Pattern.view(), Back, [&](Wildcard wildcard, std::string_view str) {
+                // The last part is empty and does not point into the pattern
+                const std::size_t begin = str.empty() ? 0 : str.data() - Pattern.data;
+                parts[ix++] = Part{.wildcard = wildcard, .begin = begin, .length = str.size(), .size = atom_count(str), .literal = is_literal(str)};
+            });
+            return parts;
+        }();
+
+        // Same layout as the NFA of Glob: a position per literal character and one for the final part
+        struct Nfa
+        {
+            std::array<std::uint64_t, 256> advance{};
+            std::uint64_t some = 0;
+            std::uint64_t all = 0;
+            std::uint64_t last = 0;
+        };
+        static constexpr std::size_t c_position_count = [] {
+            std::size_t count = 0;
+            for (const auto &part : c_parts)
+                count += std::max<std::size_t>(part.size, 1);
+            return count;
+        }();
+        static constexpr Nfa c_nfa = [] {
+            Nfa nfa;
+            if (c_position_count > 64)
+                // Only the fast paths can be used
+                return nfa;
+
+            std::size_t ix = 0;
+            for (const auto &part : c_parts)
+            {
+                const std::uint64_t bit = std::uint64_t{1} << ix;
+                switch (part.wildcard)
+                {
+                    case Wildcard::Nothing: break;
+                    case Wildcard::Some: nfa.some |= bit; break;
+                    case Wildcard::All: nfa.all |= bit; break;
+                }
+                const auto str = part.str();
+                for (std::size_t pos = 0, size; pos < str.size(); pos += size)
+                {
+                    size = atom_size(str, pos);
+                    const auto set = atom_set(str.substr(pos, size), false);
+                    for (unsigned int byte = 0; byte < 256; ++byte)
+                    {
+                        if (set.contains(byte))
+                            nfa.advance[byte] |= std::uint64_t{1} << ix;
+                    }
+                    ++ix;
+                }
+                if (part.size == 0)
+                {
+                    nfa.last = bit;
+                    ++ix;
+                }
+            }
+            return nfa;
+        }();
+    };
+
+} // namespace rubr::glob
+
+#endif
@@ -0,0 +1,237 @@
+#include <rubr/mss.hpp>
+#include <rubr/parse/Columns.hpp>
+#include <rubr/parse/numbers/Integer.hpp>
+#include <rubr/platform.h>
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <thread>
+
+namespace rubr::parse {
+
+    namespace {
+        // Smaller chunks are not worth a thread
+        constexpr std::size_t c_min_chunk_size = 4096;
+
+        // Sets the bits of the delimiter and of the '\n' and '\r' bytes in the 64 bytes at data
+        void structural_masks(const char *data, char delimiter, std::uint64_t &delims, std::uint64_t &eols)
+        {
+#if RUBR_PLATFORM_SIMD_AVX2
+            const __m256i v_delim = _mm256_set1_epi8(delimiter);
+            const __m256i v_lf = _mm256_set1_epi8('\n');
+            const __m256i v_cr = _mm256_set1_epi8('\r');
+            const __m256i lo = _mm256_loadu_si256((const __m256i *)data);
+            const __m256i hi = _mm256_loadu_si256((const __m256i *)(data + 32));
+            delims = (std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v_delim)) | (std::uint64_t)(std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v_delim)) << 32;
+            const __m256i eol_lo = _mm256_or_si256(_mm256_cmpeq_epi8(lo, v_lf), _mm256_cmpeq_epi8(lo, v_cr));
+            const __m256i eol_hi = _mm256_or_si256(_mm256_cmpeq_epi8(hi, v_lf), _mm256_cmpeq_epi8(hi, v_cr));
+            eols = (std::uint32_t)_mm256_movemask_epi8(eol_lo) | (std::uint64_t)(std::uint32_t)_mm256_movemask_epi8(eol_hi) << 32;
+#elif RUBR_PLATFORM_SIMD_SSE2
+            const __m128i v_delim = _mm_set1_epi8(delimiter);
+            const __m128i v_lf = _mm_set1_epi8('\n');
+            const __m128i v_cr = _mm_set1_epi8('\r');
+            delims = eols = 0;
+            for (unsigned int offset = 0; offset < 64; offset += 16)
+            {
+                const __m128i block = _mm_loadu_si128((const __m128i *)(data + offset));
+                delims |= (std::uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, v_delim)) << offset;
+                eols |= (std::uint64_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, v_lf), _mm_cmpeq_epi8(block, v_cr))) << offset;
+            }
+#else
+            delims = eols = 0;
+            for (unsigned int offset = 0; offset < 64; ++offset)
+            {
+                delims |= std::uint64_t{data[offset] == delimiter} << offset;
+                eols |= std::uint64_t{data[offset] == '\n' || data[offset] == '\r'} << offset;
+            }
+#endif
+        }
+    } // namespace
+
+    Columns::Columns(const std::vector<Type> &schema)
+        : Columns(schema, Config{})
+    {
+    }
+
+    Columns::Columns(const std::vector<Type> &schema, const Config &config)
+        : schema_(schema), config_(config), integers_(schema.size()), floats_(schema.size())
+    {
+    }
+
+    bool Columns::parse(std::string_view content)
+    {
+        MSS_BEGIN(bool);
+
+        const auto chunk_count = std::min<std::size_t>(thread_count_(), content.size() / c_min_chunk_size + 1);
+
+        // Each chunk but the last ends right after a '\n'
+        std::vector<std::size_t> bounds = {0};
+        for (std::size_t ix = 1; ix < chunk_count; ++ix)
+        {
+            const auto nominal = std::max(ix * content.size() / chunk_count, bounds.back());
+            const auto lf = content.find('\n', nominal);
+            bounds.push_back(lf == std::string_view::npos ? content.size() : lf + 1);
+        }
+        bounds.push_back(content.size());
+
+        std::vector<Part> parts(chunk_count);
+        // Not a std::vector<bool>, which cannot be written concurrently
+        std::vector<char> oks(chunk_count);
+        if (chunk_count == 1)
+        {
+            oks[0] = parse_(parts[0], content, 0, content.size());
+        }
+        else
+        {
+            std::vector<std::jthread> threads;
+            for (std::size_t ix = 0; ix < chunk_count; ++ix)
+                threads.emplace_back([&, ix]() { oks[ix] = parse_(parts[ix], content, bounds[ix], bounds[ix + 1]); });
+        }
+
+        for (std::size_t ix = 0; ix < chunk_count; ++ix)
+            MSS_Q(oks[ix] != 0, error_offset_ = parts[ix].error_offset);
+
+        for (auto &part : parts)
+            append_(part);
+
+        MSS_END();
+    }
+
+    void Columns::clear()
+    {
+        for (auto &column : integers_)
+            column.clear();
+        for (auto &column : floats_)
+            column.clear();
+        size_ = 0;
+        error_offset_ = 0;
+    }
+
+    // Privates
+    unsigned int Columns::thread_count_() const
+    {
+        if (config_.thread_count == 0)
+            return std::max(std::thread::hardware_concurrency(), 1u);
+        return config_.thread_count;
+    }
+
+    bool Columns::parse_(Part &part, std::string_view content, std::size_t begin, std::size_t end) const
+    {
+        const auto column_count = schema_.size();
+        part.integers.resize(column_count);
+        part.floats.resize(column_count);
+
+        const char *data = content.data();
+        // Start of the current field
+        std::size_t start = begin;
+        std::size_t col = 0;
+
+        // Parses the field that ends at pos
+        auto field = [&](std::size_t pos, bool is_eol) {
+            if (is_eol && col == 0 && pos == start)
+            {
+                // Empty line, or the '\n' of "\r\n"
+                start = pos + 1;
+                return true;
+            }
+
+            const char *s = data + start;
+            const auto size = pos - start;
+            part.error_offset = start;
+            if (col == column_count)
+                return false;
+            switch (schema_[col])
+            {
+                case Type::Integer:
+                {
+                    std::int64_t v;
+                    std::size_t len = size;
+                    if (!numbers::read(v, s, len) || len != size)
+                        return false;
+                    part.integers[col].push_back(v);
+                }
+                break;
+                case Type::Float:
+                {
+                    double v;
+                    const auto [ptr, ec] = std::from_chars(s, s + size, v);
+                    if (ec != std::errc{} || ptr != s + size)
+                        return false;
+                    part.floats[col].push_back(v);
+                }
+                break;
+                case Type::Skip: break;
+            }
+            ++col;
+
+            if (is_eol)
+            {
+                part.error_offset = pos;
+                if (col != column_count)
+                    return false;
+                col = 0;
+                ++part.size;
+            }
+            start = pos + 1;
+            return true;
+        };
+
+        for (std::size_t pos = begin; pos < end; pos += 64)
+        {
+            std::uint64_t delims, eols;
+            if (end - pos >= 64)
+            {
+                structural_masks(data + pos, config_.delimiter, delims, eols);
+            }
+            else
+            {
+                // Remainder, from a copy to stay within the buffer
+                char block[64] = {};
+                std::memcpy(block, data + pos, end - pos);
+                structural_masks(block, config_.delimiter, delims, eols);
+                const auto valid = (std::uint64_t{1} << (end - pos)) - 1;
+                delims &= valid;
+                eols &= valid;
+            }
+
+            for (auto mask = delims | eols; mask; mask &= mask - 1)
+            {
+                const auto bit = std::countr_zero(mask);
+                if (!field(pos + bit, (eols >> bit) & 1))
+                    return false;
+            }
+        }
+
+        // Last line without end-of-line
+        if (start < end || col > 0)
+        {
+            if (!field(end, true))
+                return false;
+        }
+
+        return true;
+    }
+
+    void Columns::append_(Part &part)
+    {
+        for (std::size_t col = 0; col < schema_.size(); ++col)
+        {
+            auto &integers = integers_[col];
+            auto &floats = floats_[col];
+            if (integers.empty() && floats.empty())
+            {
+                integers.swap(part.integers[col]);
+                floats.swap(part.floats[col]);
+            }
+            else
+            {
+                integers.insert(integers.end(), part.integers[col].begin(), part.integers[col].end());
+                floats.insert(floats.end(), part.floats[col].begin(), part.floats[col].end());
+            }
+        }
+        size_ += part.size;
+    }
+
+} // namespace rubr::parse
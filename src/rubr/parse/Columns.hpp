@@ -0,0 +1,79 @@
+#ifndef HEADER_rubr_parse_Columns_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_parse_Columns_hpp_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace rubr::parse {
+
+    // Numeric columns, parsed in bulk from delimited text such as CSV.
+    // The delimiters and end-of-lines of each 64 bytes are located with SIMD first, after which the fields in between
+    // are parsed in place, without splitting the buffer into lines or fields.
+    class Columns
+    {
+    public:
+        enum class Type
+        {
+            // Decimal, into std::int64_t
+            Integer,
+            Float,
+            // Field is not parsed
+            Skip,
+        };
+
+        struct Config
+        {
+            char delimiter = ',';
+            // When larger than 1, the buffer is split into this many line-aligned chunks that are parsed concurrently.
+            // Use 0 for std::thread::hardware_concurrency().
+            unsigned int thread_count = 1;
+        };
+
+        Columns(const std::vector<Type> &schema);
+        Columns(const std::vector<Type> &schema, const Config &config);
+
+        // Appends a row for each line in content, empty lines are skipped. Each line must have exactly one field per column,
+        // and Integer and Float fields must contain nothing but the number.
+        // When parsing fails, no rows are appended and error_offset() is the offset of the faulty field in content.
+        bool parse(std::string_view content);
+
+        std::size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        std::size_t column_count() const { return schema_.size(); }
+        Type type(std::size_t col) const { return schema_[col]; }
+
+        // Empty for columns of another type
+        const std::vector<std::int64_t> &integers(std::size_t col) const { return integers_[col]; }
+        const std::vector<double> &floats(std::size_t col) const { return floats_[col]; }
+
+        std::size_t error_offset() const { return error_offset_; }
+
+        void clear();
+
+    private:
+        // Rows of a chunk, one per thread
+        struct Part
+        {
+            std::vector<std::vector<std::int64_t>> integers;
+            std::vector<std::vector<double>> floats;
+            std::size_t size = 0;
+            std::size_t error_offset = 0;
+        };
+
+        unsigned int thread_count_() const;
+        bool parse_(Part &part, std::string_view content, std::size_t begin, std::size_t end) const;
+        void append_(Part &part);
+
+        const std::vector<Type> schema_;
+        const Config config_;
+        std::vector<std::vector<std::int64_t>> integers_;
+        std::vector<std::vector<double>> floats_;
+        std::size_t size_ = 0;
+        std::size_t error_offset_ = 0;
+    };
+
+} // namespace rubr::parse
+
+#endif
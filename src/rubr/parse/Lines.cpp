@@ -0,0 +1,96 @@
+#include <rubr/parse/Lines.hpp>
+#include <rubr/platform.h>
+
+#include <bit>
+
+namespace rubr::parse {
+
+    namespace {
+        // Sets the bits of the '\n' and '\r' bytes in the 64 bytes at data
+        void eol_masks(const char *data, std::uint64_t &lf, std::uint64_t &cr)
+        {
+#if RUBR_PLATFORM_SIMD_AVX2
+            const __m256i v_lf = _mm256_set1_epi8('\n');
+            const __m256i v_cr = _mm256_set1_epi8('\r');
+            const __m256i lo = _mm256_loadu_si256((const __m256i *)data);
+            const __m256i hi = _mm256_loadu_si256((const __m256i *)(data + 32));
+            lf = (std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v_lf)) | (std::uint64_t)(std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v_lf)) << 32;
+            cr = (std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v_cr)) | (std::uint64_t)(std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v_cr)) << 32;
+#elif RUBR_PLATFORM_SIMD_SSE2
+            const __m128i v_lf = _mm_set1_epi8('\n');
+            const __m128i v_cr = _mm_set1_epi8('\r');
+            lf = cr = 0;
+            for (unsigned int offset = 0; offset < 64; offset += 16)
+            {
+                const __m128i block = _mm_loadu_si128((const __m128i *)(data + offset));
+                lf |= (std::uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, v_lf)) << offset;
+                cr |= (std::uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, v_cr)) << offset;
+            }
+#else
+            lf = cr = 0;
+            for (unsigned int offset = 0; offset < 64; ++offset)
+            {
+                lf |= std::uint64_t{data[offset] == '\n'} << offset;
+                cr |= std::uint64_t{data[offset] == '\r'} << offset;
+            }
+#endif
+        }
+    } // namespace
+
+    void Lines::scan(std::string_view content)
+    {
+        content_ = content;
+        bounds_.clear();
+        bounds_.push_back(0);
+
+        const char *data = content.data();
+        const auto size = content.size();
+
+        // A '\r' that is followed by a '\n' leaves the end-of-line to that '\n'
+        auto add = [&](std::size_t ix) {
+            if (data[ix] == '\n')
+            {
+                const std::uint64_t eol = ix > 0 && data[ix - 1] == '\r' ? 2 : 1;
+                bounds_.push_back((ix + 1) | eol << c_eol_shift);
+            }
+            else if (ix + 1 == size || data[ix + 1] != '\n')
+                bounds_.push_back((ix + 1) | std::uint64_t{1} << c_eol_shift);
+        };
+
+        // 64 bytes per step keeps the branches per byte low, most steps do not contain a '\r'
+        std::size_t pos = 0;
+        for (; pos + 64 <= size; pos += 64)
+        {
+            std::uint64_t lf, cr;
+            eol_masks(data + pos, lf, cr);
+            if (!cr)
+            {
+                // A '\r' at the end of the previous step is the only one that can precede a '\n'
+                if ((lf & 1) && pos > 0 && data[pos - 1] == '\r')
+                {
+                    add(pos);
+                    lf &= lf - 1;
+                }
+                for (; lf; lf &= lf - 1)
+                    bounds_.push_back((pos + std::countr_zero(lf) + 1) | std::uint64_t{1} << c_eol_shift);
+            }
+            else
+            {
+                for (auto mask = lf | cr; mask; mask &= mask - 1)
+                    add(pos + std::countr_zero(mask));
+            }
+        }
+
+        // Remainder
+        for (; pos < size; ++pos)
+        {
+            if (data[pos] == '\n' || data[pos] == '\r')
+                add(pos);
+        }
+
+        // An end-of-line at the end already added the final boundary
+        if ((bounds_.back() & c_offset_mask) != size)
+            bounds_.push_back(size);
+    }
+
+} // namespace rubr::parse
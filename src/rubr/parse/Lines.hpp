@@ -0,0 +1,69 @@
+#ifndef HEADER_rubr_parse_Lines_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_parse_Lines_hpp_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace rubr::parse {
+
+    // Boundaries of all lines in a buffer, found in a single SIMD pass.
+    // '\n', "\r\n" and a lone '\r' all end a line. As with Strange::pop_line(), an end-of-line at the end of the
+    // buffer does not start an extra empty line. Unlike pop_line(), a lone '\r' also ends a line when a '\n'
+    // occurs further on.
+    // The buffer is referenced, not copied: it must outlive the Lines.
+    class Lines
+    {
+    public:
+        // Replaces the previous boundaries, reusing their memory
+        void scan(std::string_view content);
+
+        std::size_t size() const { return bounds_.size() - 1; }
+        bool empty() const { return size() == 0; }
+
+        // Line ix, without its end-of-line. Does not access the buffer.
+        std::string_view operator[](std::size_t ix) const
+        {
+            const auto begin = start(ix);
+            const auto end = start(ix + 1) - (bounds_[ix + 1] >> c_eol_shift);
+            return std::string_view{content_.data() + begin, end - begin};
+        }
+
+        // Offset of line ix in the buffer. start(size()) is the size of the buffer.
+        std::size_t start(std::size_t ix) const { return bounds_[ix] & c_offset_mask; }
+
+        class Iterator
+        {
+        public:
+            Iterator(const Lines &lines, std::size_t ix)
+                : lines_(&lines), ix_(ix) {}
+
+            std::string_view operator*() const { return (*lines_)[ix_]; }
+            Iterator &operator++()
+            {
+                ++ix_;
+                return *this;
+            }
+            bool operator==(const Iterator &rhs) const { return ix_ == rhs.ix_; }
+
+        private:
+            const Lines *lines_;
+            std::size_t ix_;
+        };
+        Iterator begin() const { return Iterator{*this, 0}; }
+        Iterator end() const { return Iterator{*this, size()}; }
+
+    private:
+        // The size of the end-of-line in front of a start is stored in its upper bits
+        static constexpr unsigned int c_eol_shift = 62;
+        static constexpr std::uint64_t c_offset_mask = (std::uint64_t{1} << c_eol_shift) - 1;
+
+        std::string_view content_;
+        // Start of each line, followed by the size of the buffer
+        std::vector<std::uint64_t> bounds_ = {0};
+    };
+
+} // namespace rubr::parse
+
+#endif
@@ -1,7 +1,10 @@
 #include <rubr/parse/Strange.hpp>
 #include <rubr/debug/log.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <charconv>
+#include <limits>
 
 namespace rubr::parse {
 
@@ -19,7 +22,7 @@ namespace rubr::parse {
     }
 
     Strange::Strange(const Strange &rhs)
-        : b_(rhs.b_), s_(rhs.s_), l_(rhs.l_)
+        : b_(rhs.b_), s_(rhs.s_), l_(rhs.l_), line_index_(rhs.line_index_)
     {
     }
 
@@ -28,6 +31,7 @@ namespace rubr::parse {
         b_ = rhs.b_;
         s_ = rhs.s_;
         l_ = rhs.l_;
+        line_index_ = rhs.line_index_;
         return *this;
     }
     Strange &Strange::operator=(const std::string &str)
@@ -35,6 +39,7 @@ namespace rubr::parse {
         b_ = str.data();
         s_ = str.data();
         l_ = str.size();
+        line_index_.reset();
         return *this;
     }
 
@@ -90,13 +95,14 @@ namespace rubr::parse {
     }
     unsigned int Strange::strip_left(const std::string &chars)
     {
-        unsigned int count = 0;
-        for (; !empty(); pop_front())
-        {
-            if (chars.find(front()) == std::string::npos)
-                break;
-            ++count;
-        }
+        return strip_left(strng::CharSet{chars});
+    }
+    unsigned int Strange::strip_left(const strng::CharSet &chars)
+    {
+        auto count = chars.find_not(view());
+        if (count == strng::CharSet::npos)
+            count = l_;
+        forward_(count);
         return count;
     }
 
@@ -113,13 +119,13 @@ namespace rubr::parse {
     }
     unsigned int Strange::strip_right(const std::string &chars)
     {
-        unsigned int count = 0;
-        for (; !empty(); pop_back())
-        {
-            if (chars.find(back()) == std::string::npos)
-                break;
-            ++count;
-        }
+        return strip_right(strng::CharSet{chars});
+    }
+    unsigned int Strange::strip_right(const strng::CharSet &chars)
+    {
+        const auto ix = chars.rfind_not(view());
+        const auto count = l_ - (ix == strng::CharSet::npos ? 0 : ix + 1);
+        shrink_(count);
         return count;
     }
 
@@ -144,8 +150,7 @@ namespace rubr::parse {
                 --level;
                 if (level == 0)
                 {
-                    res.s_ = sp.s_;
-                    res.l_ = s_ - res.s_;
+                    view_(res, sp.s_, s_ - sp.s_);
                     pop_front();
                     return true;
                 }
@@ -192,8 +197,7 @@ namespace rubr::parse {
         char *ptr = (char *)std::memchr(s_, ch, l_);
         if (!ptr)
             return false;
-        res.s_ = s_;
-        res.l_ = ptr - s_;
+        view_(res, s_, ptr - s_);
         forward_(res.l_);
         return true;
     }
@@ -210,51 +214,24 @@ namespace rubr::parse {
     }
     // Does not pop str
     bool Strange::pop_to(Strange &res, const std::string &str)
+    {
+        return pop_to(res, strng::Needle{str});
+    }
+    bool Strange::pop_to(Strange &res, const strng::Needle &needle)
     {
         assert(invariants_());
-        if (str.empty())
+        if (needle.empty())
             return false;
-        // We will iteratively search for ch, and try to match the rest of str
-        const char ch = str[0];
-        const size_t s = str.size();
-        const Strange sp = *this;
-        while (char *ptr = (char *)std::memchr(s_, ch, l_))
-        {
-            const size_t l = ptr - s_;
-            forward_(l);
-            if (size() < s)
-                break;
-            if (0 == std::memcmp(str.data(), s_, s))
-            {
-                // We found a match at this location
-                res.s_ = sp.s_;
-                res.l_ = s_ - res.s_;
-                return true;
-            }
-            else
-            {
-                // No full match was found, we forward to the next character and try again
-                forward_(1);
-            }
-        }
-        *this = sp;
-        return false;
+        const auto i = needle.find(view());
+        if (i == strng::Needle::npos)
+            return false;
+        view_(res, s_, i);
+        forward_(i);
+        return true;
     }
     bool Strange::pop_to_any(Strange &res, const std::string &str)
     {
-        assert(invariants_());
-        if (empty())
-            return false;
-        for (size_t i = 0; i < l_; ++i)
-            if (str.find(s_[i]) != std::string::npos)
-            {
-                res.s_ = s_;
-                res.l_ = i;
-                forward_(i);
-                return true;
-            }
-
-        return false;
+        return pop_to_any(res, strng::CharSet{str});
     }
     bool Strange::pop_to_any(std::string &res, const std::string &str)
     {
@@ -264,6 +241,18 @@ namespace rubr::parse {
         res = s.str();
         return true;
     }
+    bool Strange::pop_to_any(Strange &res, const strng::CharSet &chars)
+    {
+        assert(invariants_());
+        if (empty())
+            return false;
+        const auto i = chars.find(view());
+        if (i == strng::CharSet::npos)
+            return false;
+        view_(res, s_, i);
+        forward_(i);
+        return true;
+    }
     bool Strange::diff_to(const Strange &strange)
     {
         if (empty())
@@ -287,8 +276,7 @@ namespace rubr::parse {
         for (size_t i = 0; i < l_; ++i)
             if (s_[i] == ch)
             {
-                res.s_ = s_;
-                res.l_ = i + (inclusive ? 1 : 0);
+                view_(res, s_, i + (inclusive ? 1 : 0));
                 forward_(i + 1);
                 return true;
             }
@@ -305,28 +293,7 @@ namespace rubr::parse {
     }
     bool Strange::pop_until(Strange &res, const std::string &str, bool inclusive)
     {
-        assert(invariants_());
-        if (str.empty())
-            return true;
-        const size_t s = str.size();
-        if (size() < s)
-            // We are to small to match str
-            return false;
-        const auto ch = str.front();
-        const auto l2check = l_ - s + 1;
-        for (size_t i = 0; i < l2check; ++i)
-            if (s_[i] == ch)
-            {
-                // Pontential match, check the rest of str
-                if (!std::memcmp(str.data(), s_ + i, s))
-                {
-                    res.s_ = s_;
-                    res.l_ = i + (inclusive ? s : 0);
-                    forward_(i + s);
-                    return true;
-                }
-            }
-        return false;
+        return pop_until(res, strng::Needle{str}, inclusive);
     }
     bool Strange::pop_until(std::string &res, const std::string &str, bool inclusive)
     {
@@ -336,6 +303,19 @@ namespace rubr::parse {
         res = s.str();
         return true;
     }
+    bool Strange::pop_until(Strange &res, const strng::Needle &needle, bool inclusive)
+    {
+        assert(invariants_());
+        if (needle.empty())
+            return true;
+        const auto i = needle.find(view());
+        if (i == strng::Needle::npos)
+            return false;
+        const auto s = needle.size();
+        view_(res, s_, i + (inclusive ? s : 0));
+        forward_(i + s);
+        return true;
+    }
     bool Strange::pop_until(const char ch)
     {
         assert(invariants_());
@@ -352,19 +332,7 @@ namespace rubr::parse {
     }
     bool Strange::pop_until_any(Strange &res, const std::string &str, bool inclusive)
     {
-        assert(invariants_());
-        if (empty())
-            return false;
-        for (size_t i = 0; i < l_; ++i)
-            if (str.find(s_[i]) != std::string::npos)
-            {
-                res.s_ = s_;
-                res.l_ = i + (inclusive ? 1 : 0);
-                forward_(i + 1);
-                return true;
-            }
-
-        return false;
+        return pop_until_any(res, strng::CharSet{str}, inclusive);
     }
     bool Strange::pop_until_any(std::string &res, const std::string &str, bool inclusive)
     {
@@ -374,43 +342,31 @@ namespace rubr::parse {
         res = s.str();
         return true;
     }
-    bool Strange::pop_decimal(long &res)
+    bool Strange::pop_until_any(Strange &res, const strng::CharSet &chars, bool inclusive)
     {
         assert(invariants_());
         if (empty())
             return false;
-        size_t l = l_;
-        if (!parse::numbers::read(res, s_, l))
+        const auto i = chars.find(view());
+        if (i == strng::CharSet::npos)
             return false;
-        forward_(l);
+        view_(res, s_, i + (inclusive ? 1 : 0));
+        forward_(i + 1);
         return true;
     }
-    bool Strange::pop_float(double &res)
-    {
-        assert(invariants_());
-        if (empty())
-            return false;
-        char *e = 0;
-        double d = std::strtod(s_, &e);
-        if (e == s_)
-            return false;
-        res = d;
-        forward_(e - s_);
-        return true;
-    }
-    bool Strange::pop_float(float &res)
+    bool Strange::pop_decimal(long &res)
     {
         assert(invariants_());
         if (empty())
             return false;
-        char *e = 0;
-        float d = std::strtof(s_, &e);
-        if (e == s_)
+        size_t l = l_;
+        if (!numbers::read(res, s_, l))
             return false;
-        res = d;
-        forward_(e - s_);
+        forward_(l);
         return true;
     }
+    bool Strange::pop_float(double &res) { return pop_float_(res); }
+    bool Strange::pop_float(float &res) { return pop_float_(res); }
 
     bool Strange::pop_if(const char ch)
     {
@@ -520,7 +476,7 @@ namespace rubr::parse {
         if (empty())
             return false;
 
-        line.s_ = s_;
+        view_(line, s_, 0);
 
 
         // We start looking for 0xa because that is the most likely indicator of an end-of-line
@@ -570,7 +526,7 @@ namespace rubr::parse {
             }
         }
 
-        end.s_ = s_ + line.l_;
+        view_(end, s_ + line.l_, end.l_);
         forward_(line.l_ + end.l_);
 
         return true;
@@ -597,7 +553,7 @@ namespace rubr::parse {
         v = 0;
         for (unsigned int i = 0; i < sizeof(v); ++i)
         {
-            T tmp = *(const T *)(s_ + i);
+            T tmp = *(const std::uint8_t *)(s_ + i);
             tmp <<= i * 8;
             v |= tmp;
         }
@@ -649,8 +605,7 @@ namespace rubr::parse {
     {
         if (l_ < nr)
             return false;
-        res.s_ = s_;
-        res.l_ = nr;
+        view_(res, s_, nr);
         forward_(nr);
         return true;
     }
@@ -680,12 +635,52 @@ namespace rubr::parse {
         return ix::Range(s_ - b_, size());
     }
 
+    void Strange::enable_line_index()
+    {
+        line_index_ = std::make_shared<LineIndex>();
+        line_index_->size = s_ + l_ - b_;
+    }
+
     Strange::Position Strange::position() const
     {
         Position pos;
 
         pos.ix = (s_ - b_);
 
+        if (line_index_ && pos.ix <= line_index_->size)
+        {
+            auto &index = *line_index_;
+            std::call_once(index.once, [&]() {
+                for (auto ptr = b_, end = b_ + index.size; (ptr = (const char *)std::memchr(ptr, '\n', end - ptr)); ++ptr)
+                    index.newlines.push_back(ptr - b_);
+            });
+            const auto &newlines = index.newlines;
+
+            // Number of '\n' in front of pos.ix, searched for from the previous query
+            std::size_t line = std::min(index.cursor.load(std::memory_order_relaxed), newlines.size());
+            if (line > 0 && newlines[line - 1] >= pos.ix)
+            {
+                line = std::lower_bound(newlines.begin(), newlines.begin() + line, pos.ix) - newlines.begin();
+            }
+            else
+            {
+                // Galloping keeps small steps forward cheap, all newlines before lo are in front of pos.ix
+                std::size_t lo = line, hi = line;
+                for (std::size_t step = 1; hi < newlines.size() && newlines[hi] < pos.ix; step *= 2)
+                {
+                    lo = hi + 1;
+                    hi += step;
+                }
+                hi = std::min(hi, newlines.size());
+                line = std::lower_bound(newlines.begin() + lo, newlines.begin() + hi, pos.ix) - newlines.begin();
+            }
+            index.cursor.store(line, std::memory_order_relaxed);
+
+            pos.line = line;
+            pos.column = pos.ix - (line > 0 ? newlines[line - 1] + 1 : 0);
+            return pos;
+        }
+
         for (auto ptr = b_; ptr != s_; ++ptr)
             if (*ptr == '\n')
             {
@@ -699,6 +694,81 @@ namespace rubr::parse {
     }
 
     // Privates
+    template<typename T>
+    bool Strange::pop_float_(T &res)
+    {
+        assert(invariants_());
+        const char *ptr = s_;
+        const char *end = s_ + l_;
+
+        // Leading whitespace and '+' are accepted, as strtod() does
+        // ASCII whitespace as in the "C" locale, independent of the current one
+        static const strng::CharSet whitespace{" \t\n\v\f\r"};
+        const auto ix = whitespace.find_not(view());
+        ptr += ix == strng::CharSet::npos ? l_ : ix;
+        if (ptr != end && *ptr == '+')
+        {
+            ++ptr;
+            if (ptr != end && *ptr == '-')
+                return false;
+        }
+
+        T value;
+        const auto [last, ec] = std::from_chars(ptr, end, value);
+        if (ec == std::errc::invalid_argument)
+            return false;
+        if (ec == std::errc::result_out_of_range)
+        {
+            // from_chars() does not set value, strtod() returns +-inf on overflow and +-0 on underflow.
+            // The decimal exponent of the first significant digit decides which of both applies.
+            const bool negative = *ptr == '-';
+            long exponent = 0;
+            bool significant = false, fraction = false;
+            const char *p = negative ? ptr + 1 : ptr;
+            for (; p != last && *p != 'e' && *p != 'E'; ++p)
+            {
+                if (*p == '.')
+                    fraction = true;
+                else if (!fraction)
+                {
+                    if (significant || *p != '0')
+                    {
+                        significant = true;
+                        ++exponent;
+                    }
+                }
+                else if (!significant)
+                {
+                    if (*p == '0')
+                        --exponent;
+                    else
+                        significant = true;
+                }
+            }
+            if (p != last)
+            {
+                long e = 0;
+                if (std::from_chars(p + 1 + (p[1] == '+'), last, e).ec == std::errc::result_out_of_range)
+                    e = p[1] == '-' ? std::numeric_limits<long>::min() / 2 : std::numeric_limits<long>::max() / 2;
+                exponent += e;
+            }
+            value = exponent > 0 ? std::numeric_limits<T>::infinity() : T{0};
+            if (negative)
+                value = -value;
+        }
+
+        res = value;
+        forward_(last - s_);
+        return true;
+    }
+
+    void Strange::view_(Strange &res, const char *s, size_t l) const
+    {
+        res.b_ = b_;
+        res.s_ = s;
+        res.l_ = l;
+        res.line_index_ = line_index_;
+    }
     bool Strange::invariants_() const
     {
         if (!s_ && l_)
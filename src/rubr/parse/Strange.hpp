@@ -3,12 +3,20 @@
 
 #include <rubr/ix/Range.hpp>
 #include <rubr/parse/numbers/Integer.hpp>
+#include <rubr/strng/CharSet.hpp>
+#include <rubr/strng/Needle.hpp>
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 //&todo: The methods that take a Strange& as argument are currently not correct when this argument is the same as the this pointer
 //&todo: Clear strange/string argument when pop fails
@@ -43,6 +51,7 @@ namespace rubr::parse {
         bool empty() const;
         size_t size() const;
         std::string str() const;
+        std::string_view view() const { return std::string_view{s_, l_}; }
         char front() const;
         char back() const;
         char operator[](std::size_t ix) const;
@@ -51,29 +60,37 @@ namespace rubr::parse {
 
         bool contains(char ch) const;
 
+        // The overloads that take a std::string build a strng::CharSet on each call: prefer passing one for repeated use
         unsigned int strip_left(char ch);
         unsigned int strip_left(const std::string &chars);
+        unsigned int strip_left(const strng::CharSet &chars);
         unsigned int strip_right(char ch);
         unsigned int strip_right(const std::string &chars);
+        unsigned int strip_right(const strng::CharSet &chars);
 
         // Return true if !res.empty()
         bool pop_all(Strange &res);
         bool pop_all(std::string &res);
 
         // Does not pop ch or str
+        // The overloads that take a std::string build a strng::Needle on each call: prefer passing one for repeated use
         bool pop_to(Strange &res, const char ch);
         bool pop_to(const char ch);
         bool pop_to(Strange &res, const std::string &str);
+        bool pop_to(Strange &res, const strng::Needle &needle);
         bool pop_to_any(Strange &res, const std::string &str);
         bool pop_to_any(std::string &res, const std::string &str);
+        bool pop_to_any(Strange &res, const strng::CharSet &chars);
         // Pops ch too, set inclusive to true if you want ch to be included in res
         bool pop_until(Strange &res, const char ch, bool inclusive = false);
         bool pop_until(std::string &res, const char ch, bool inclusive = false);
         bool pop_until(Strange &res, const std::string &str, bool inclusive = false);
         bool pop_until(std::string &res, const std::string &str, bool inclusive = false);
+        bool pop_until(Strange &res, const strng::Needle &needle, bool inclusive = false);
         bool pop_until(const char ch);
         bool pop_until_any(Strange &res, const std::string &str, bool inclusive = false);
         bool pop_until_any(std::string &res, const std::string &str, bool inclusive = false);
+        bool pop_until_any(Strange &res, const strng::CharSet &chars, bool inclusive = false);
 
         bool pop_bracket(Strange &res, const std::string &oc);
         bool pop_bracket(std::string &res, const std::string &oc);
@@ -82,16 +99,28 @@ namespace rubr::parse {
         // this and strange are assumed to be related and have the same end
         bool diff_to(const Strange &strange);
 
+        // Fails when the value does not fit in the integer type, a '-' is only accepted for signed types
         bool pop_decimal(long &res);
         template<typename Int>
         bool pop_decimal(Int &i)
         {
-            long l;
-            if (!pop_decimal(l))
+            size_t l = l_;
+            if (!numbers::read(i, s_, l))
                 return false;
-            i = l;
+            forward_(l);
             return true;
         }
+        // Hexadecimal digits, without prefix
+        template<typename Int>
+        bool pop_hex(Int &i)
+        {
+            size_t l = l_;
+            if (!numbers::read_hex(i, s_, l))
+                return false;
+            forward_(l);
+            return true;
+        }
+        // Locale-independent and bounded by size(). Accepts what strtod() accepts, except hexadecimal floats.
         bool pop_float(double &res);
         bool pop_float(float &res);
 
@@ -145,20 +174,42 @@ namespace rubr::parse {
         }
 
         ix::Range ix_range() const;
+        // Counts the lines from the start of the buffer, unless enable_line_index() was called
         Position position() const;
 
+        // Builds an index of all '\n' in the buffer on the first call to position(). position() then takes
+        // O(log n) instead of O(n), and queries that move forward a little are close to O(1).
+        // The index is shared by copies and by all views that are popped from this Strange afterwards.
+        void enable_line_index();
+
     private:
         template<typename T>
         bool pop_lsb_(T &);
         template<typename T>
         bool pop_msb_(T &);
+        template<typename T>
+        bool pop_float_(T &);
         bool invariants_() const;
         void forward_(const size_t nr);
         void shrink_(const size_t nr);
+        // Sets res to the view [s, s+l) in the same buffer
+        void view_(Strange &res, const char *s, size_t l) const;
+
+        struct LineIndex
+        {
+            // Of the buffer, starting at b_
+            std::size_t size = 0;
+            std::once_flag once;
+            // Offsets of all '\n'
+            std::vector<std::size_t> newlines;
+            // Line of the previous query
+            std::atomic<std::size_t> cursor{0};
+        };
 
         const char *b_;
         const char *s_;
         size_t l_;
+        std::shared_ptr<LineIndex> line_index_;
     };
 
     inline std::ostream &operator<<(std::ostream &os, const Strange &strange)
@@ -0,0 +1,171 @@
+#include <rubr/parse/numbers/Integer.hpp>
+#include <rubr/platform.h>
+
+#include <bit>
+#include <cstring>
+
+namespace rubr::parse::numbers::priv {
+
+    namespace {
+        constexpr std::uint64_t c_bytes_01 = 0x0101010101010101ull;
+        constexpr std::uint64_t c_bytes_80 = 0x8080808080808080ull;
+
+        constexpr std::uint64_t c_pow10[] = {1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull};
+
+        // The (at most) 8 bytes at buf, with the first char in the lowest byte. Missing bytes are 0, which is not a digit.
+        std::uint64_t load(const char *buf, std::size_t size)
+        {
+            std::uint64_t chunk = 0;
+            std::memcpy(&chunk, buf, size < 8 ? size : 8);
+            if constexpr (std::endian::native == std::endian::big)
+                chunk = std::byteswap(chunk);
+            return chunk;
+        }
+
+        // Sets the high bit of each byte that is not a decimal digit
+        std::uint64_t non_decimal(std::uint64_t chunk)
+        {
+            // Digits map to [0, 9], adding 0x76 without carry sets the high bit for larger values
+            const auto a = chunk ^ (0x30 * c_bytes_01);
+            return (((a & ~c_bytes_80) + 0x76 * c_bytes_01) | a) & c_bytes_80;
+        }
+
+        // Value of the 8 decimal digits in chunk
+        std::uint32_t eight_decimal(std::uint64_t chunk)
+        {
+            chunk = (chunk & 0x0f0f0f0f0f0f0f0full) * (1 + (10 << 8)) >> 8;
+            chunk = (chunk & 0x00ff00ff00ff00ffull) * (1 + (100 << 16)) >> 16;
+            return (std::uint32_t)((chunk & 0x0000ffff0000ffffull) * (1 + (10000ull << 32)) >> 32);
+        }
+
+#if RUBR_PLATFORM_SIMD_SSE42 || RUBR_PLATFORM_SIMD_AVX2
+        // Reads up to 16 digits from the 16 bytes at buf, returns the number of digits
+        unsigned int sixteen_decimal(std::uint64_t &v, const char *buf)
+        {
+            const __m128i values = _mm_sub_epi8(_mm_loadu_si128((const __m128i *)buf), _mm_set1_epi8('0'));
+            const __m128i nine = _mm_set1_epi8(9);
+            const unsigned int n = std::countr_one((unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(values, nine), nine)));
+            if (n == 0)
+                return 0;
+
+            // Moves the digits to the end, shifting in zeros: a negative index clears its byte
+            const __m128i ix = _mm_add_epi8(_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm_set1_epi8((char)(n - 16)));
+            const __m128i digits = _mm_shuffle_epi8(values, ix);
+
+            // Combines pairs of digits, then of pairs, until two values of 8 digits remain
+            const __m128i t1 = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+            const __m128i t2 = _mm_madd_epi16(t1, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+            const __m128i t3 = _mm_packus_epi32(t2, t2);
+            const __m128i t4 = _mm_madd_epi16(t3, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+            v = (std::uint64_t)(std::uint32_t)_mm_cvtsi128_si32(t4) * 100000000 + (std::uint32_t)_mm_extract_epi32(t4, 1);
+            return n;
+        }
+#endif
+    } // namespace
+
+    bool read_decimal_digits(std::uint64_t &v, const char *buf, std::size_t &len)
+    {
+        std::uint64_t value = 0;
+        std::size_t pos = 0;
+
+#if RUBR_PLATFORM_SIMD_SSE42 || RUBR_PLATFORM_SIMD_AVX2
+        if (len >= 16)
+        {
+            pos = sixteen_decimal(value, buf);
+            if (pos < 16)
+            {
+                if (pos == 0)
+                    return false;
+                v = value;
+                len = pos;
+                return true;
+            }
+        }
+#else
+        if (len >= 16)
+        {
+            // Without branching on the number of digits in the first step, which is hard to predict
+            const auto chunk0 = load(buf, 8);
+            const auto chunk1 = load(buf + 8, 8);
+            const auto n0 = (unsigned int)std::countr_zero(non_decimal(chunk0)) / 8;
+            if (n0 == 0)
+                return false;
+            const auto n1 = n0 == 8 ? (unsigned int)std::countr_zero(non_decimal(chunk1)) / 8 : 0u;
+            const std::uint64_t digits1 = n1 == 0 ? 0 : eight_decimal(chunk1 << ((64 - 8 * n1) & 63));
+            value = eight_decimal(chunk0 << (64 - 8 * n0)) * c_pow10[n1] + digits1;
+            pos = n0 + n1;
+            if (pos < 16)
+            {
+                v = value;
+                len = pos;
+                return true;
+            }
+        }
+#endif
+
+        while (pos < len)
+        {
+            const auto chunk = load(buf + pos, len - pos);
+            const auto n = (unsigned int)std::countr_zero(non_decimal(chunk)) / 8;
+            if (n == 0)
+                break;
+
+            // Shifting the digits to the top prepends zeros
+            const std::uint64_t digits = eight_decimal(chunk << (64 - 8 * n));
+            // Values of up to 19 digits fit in 64 bits
+            if (pos + n > 19 && value > (std::numeric_limits<std::uint64_t>::max() - digits) / c_pow10[n])
+                return false;
+            value = value * c_pow10[n] + digits;
+            pos += n;
+
+            if (n < 8)
+                break;
+        }
+
+        if (pos == 0)
+            return false;
+        v = value;
+        len = pos;
+        return true;
+    }
+
+    bool read_hex_digits(std::uint64_t &v, const char *buf, std::size_t &len)
+    {
+        std::uint64_t value = 0;
+        std::size_t pos = 0;
+
+        while (pos < len)
+        {
+            const auto chunk = load(buf + pos, len - pos);
+
+            // 'a'-'f' and 'A'-'F' map to [1, 6]
+            const auto b = (chunk | (0x20 * c_bytes_01)) ^ (0x60 * c_bytes_01);
+            const auto non_letter = ((((b & ~c_bytes_80) + 0x79 * c_bytes_01) | b) | ~((b & ~c_bytes_80) + 0x7f * c_bytes_01)) & c_bytes_80;
+            const auto n = (unsigned int)std::countr_zero(non_decimal(chunk) & non_letter) / 8;
+            if (n == 0)
+                break;
+
+            // One nibble per byte, the last digit in the lowest byte
+            auto nibbles = (chunk & (0x0f * c_bytes_01)) + ((~non_letter >> 7) & c_bytes_01) * 9;
+            nibbles = std::byteswap(nibbles << (64 - 8 * n));
+            nibbles = (nibbles | nibbles >> 4) & 0x00ff00ff00ff00ffull;
+            nibbles = (nibbles | nibbles >> 8) & 0x0000ffff0000ffffull;
+            nibbles = (nibbles | nibbles >> 16) & 0x00000000ffffffffull;
+
+            if (pos + n > 16 && (value >> (64 - 4 * n)) != 0)
+                return false;
+            value = value << (4 * n) | nibbles;
+            pos += n;
+
+            if (n < 8)
+                break;
+        }
+
+        if (pos == 0)
+            return false;
+        v = value;
+        len = pos;
+        return true;
+    }
+
+} // namespace rubr::parse::numbers::priv
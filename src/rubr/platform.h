@@ -25,6 +25,8 @@
     #error Not all endian defines are set
 #endif
 
+#include <rubr/platform/simd.h>
+
 #if 0
     #if !defined(RUBR_PLATFORM_BITS)
         #error RUBR_PLATFORM_BITS is not available
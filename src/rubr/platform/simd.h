@@ -0,0 +1,22 @@
+#ifndef HEADER_rubr_platform_simd_h_ALREADY_INCLUDED
+#define HEADER_rubr_platform_simd_h_ALREADY_INCLUDED
+
+// Instruction sets that are enabled at compile time, e.g. with `-mavx2` or `-march=native`
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define RUBR_PLATFORM_SIMD_SSE2 1
+#endif
+
+#if defined(__SSE4_2__)
+    #define RUBR_PLATFORM_SIMD_SSE42 1
+#endif
+
+#if defined(__AVX2__)
+    #define RUBR_PLATFORM_SIMD_AVX2 1
+#endif
+
+#if RUBR_PLATFORM_SIMD_SSE2 || RUBR_PLATFORM_SIMD_AVX2
+    #include <immintrin.h>
+#endif
+
+#endif
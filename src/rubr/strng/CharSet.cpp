@@ -0,0 +1,147 @@
+#include <rubr/platform.h>
+#include <rubr/strng/CharSet.hpp>
+
+#include <bit>
+
+#if RUBR_PLATFORM_SIMD_SSE42 || RUBR_PLATFORM_SIMD_AVX2
+    #define RUBR_STRNG_CHARSET_SHUFFLE 1
+#endif
+
+namespace rubr::strng {
+
+    namespace {
+#if RUBR_STRNG_CHARSET_SHUFFLE
+        // Sets all bits of the bytes in block that are in the set described by the lo and hi tables
+        __m128i members(__m128i block, __m128i lo, __m128i hi)
+        {
+            // A shuffle index with its high bit set produces 0: each byte selects its row from exactly one table
+            const __m128i rows = _mm_or_si128(_mm_shuffle_epi8(lo, block), _mm_shuffle_epi8(hi, _mm_xor_si128(block, _mm_set1_epi8((char)0x80))));
+            const __m128i high = _mm_and_si128(_mm_srli_epi16(block, 4), _mm_set1_epi8(0x07));
+            const __m128i bit = _mm_shuffle_epi8(_mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128), high);
+            return _mm_cmpeq_epi8(_mm_and_si128(rows, bit), bit);
+        }
+#endif
+#if RUBR_PLATFORM_SIMD_AVX2
+        __m256i members(__m256i block, __m256i lo, __m256i hi)
+        {
+            const __m256i rows = _mm256_or_si256(_mm256_shuffle_epi8(lo, block), _mm256_shuffle_epi8(hi, _mm256_xor_si256(block, _mm256_set1_epi8((char)0x80))));
+            const __m256i high = _mm256_and_si256(_mm256_srli_epi16(block, 4), _mm256_set1_epi8(0x07));
+            const __m256i bit = _mm256_shuffle_epi8(_mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128), high);
+            return _mm256_cmpeq_epi8(_mm256_and_si256(rows, bit), bit);
+        }
+#endif
+    } // namespace
+
+    CharSet::CharSet(std::string_view chars)
+    {
+        for (const auto ch : chars)
+            add(ch);
+    }
+
+    void CharSet::add(char ch)
+    {
+        const auto byte = (std::uint8_t)ch;
+        bits_[byte >> 6] |= std::uint64_t{1} << (byte & 63);
+        const auto high = byte >> 4;
+        if (high < 8)
+            lo_[byte & 15] |= 1u << high;
+        else
+            hi_[byte & 15] |= 1u << (high - 8);
+    }
+
+    std::size_t CharSet::find(std::string_view str, std::size_t pos) const
+    {
+        return find_<true>(str, pos);
+    }
+
+    std::size_t CharSet::find_not(std::string_view str, std::size_t pos) const
+    {
+        return find_<false>(str, pos);
+    }
+
+    std::size_t CharSet::rfind_not(std::string_view str) const
+    {
+        const char *data = str.data();
+        std::size_t end = str.size();
+
+#if RUBR_PLATFORM_SIMD_AVX2
+        {
+            const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)lo_));
+            const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hi_));
+            for (; end >= 32; end -= 32)
+            {
+                const auto mask = ~(std::uint32_t)_mm256_movemask_epi8(members(_mm256_loadu_si256((const __m256i *)(data + end - 32)), lo, hi));
+                if (mask)
+                    return end - 1 - std::countl_zero(mask);
+            }
+        }
+#endif
+#if RUBR_STRNG_CHARSET_SHUFFLE
+        {
+            const __m128i lo = _mm_loadu_si128((const __m128i *)lo_);
+            const __m128i hi = _mm_loadu_si128((const __m128i *)hi_);
+            for (; end >= 16; end -= 16)
+            {
+                const auto mask = ~(std::uint32_t)_mm_movemask_epi8(members(_mm_loadu_si128((const __m128i *)(data + end - 16)), lo, hi)) << 16;
+                if (mask)
+                    return end - 1 - std::countl_zero(mask);
+            }
+        }
+#endif
+
+        // Remainder, or everything when no SIMD is available
+        while (end > 0)
+        {
+            --end;
+            if (!contains(data[end]))
+                return end;
+        }
+        return npos;
+    }
+
+    // Privates
+    template<bool Member>
+    std::size_t CharSet::find_(std::string_view str, std::size_t pos) const
+    {
+        const char *data = str.data();
+        const auto size = str.size();
+
+#if RUBR_PLATFORM_SIMD_AVX2
+        {
+            const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)lo_));
+            const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hi_));
+            for (; pos + 32 <= size; pos += 32)
+            {
+                auto mask = (std::uint32_t)_mm256_movemask_epi8(members(_mm256_loadu_si256((const __m256i *)(data + pos)), lo, hi));
+                if constexpr (!Member)
+                    mask = ~mask;
+                if (mask)
+                    return pos + std::countr_zero(mask);
+            }
+        }
+#endif
+#if RUBR_STRNG_CHARSET_SHUFFLE
+        {
+            const __m128i lo = _mm_loadu_si128((const __m128i *)lo_);
+            const __m128i hi = _mm_loadu_si128((const __m128i *)hi_);
+            for (; pos + 16 <= size; pos += 16)
+            {
+                auto mask = (std::uint32_t)_mm_movemask_epi8(members(_mm_loadu_si128((const __m128i *)(data + pos)), lo, hi));
+                if constexpr (!Member)
+                    mask ^= 0xffff;
+                if (mask)
+                    return pos + std::countr_zero(mask);
+            }
+        }
+#endif
+
+        // Remainder, or everything when no SIMD is available
+        for (; pos < size; ++pos)
+        {
+            if (contains(data[pos]) == Member)
+                return pos;
+        }
+        return npos;
+    }
+
+} // namespace rubr::strng
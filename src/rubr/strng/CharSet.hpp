@@ -0,0 +1,46 @@
+#ifndef HEADER_rubr_strng_CharSet_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_strng_CharSet_hpp_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace rubr::strng {
+
+    // Precompiled set of bytes, searched for 32 (AVX2) or 16 (SSE4.2) bytes at a time.
+    // Membership of a block is computed with two nibble-indexed shuffle tables: the low nibble selects a row,
+    // the high nibble selects a bit in that row. Without SIMD, a 256-bit bitmap is used.
+    class CharSet
+    {
+    public:
+        static constexpr std::size_t npos = std::string_view::npos;
+
+        CharSet() {}
+        explicit CharSet(std::string_view chars);
+
+        void add(char ch);
+        bool contains(char ch) const
+        {
+            const auto byte = (std::uint8_t)ch;
+            return (bits_[byte >> 6] >> (byte & 63)) & 1;
+        }
+
+        // Offset of the first byte in str at or after pos that is (not) in the set, or npos
+        std::size_t find(std::string_view str, std::size_t pos = 0) const;
+        std::size_t find_not(std::string_view str, std::size_t pos = 0) const;
+        // Offset of the last byte in str that is not in the set, or npos
+        std::size_t rfind_not(std::string_view str) const;
+
+    private:
+        template<bool Member>
+        std::size_t find_(std::string_view str, std::size_t pos) const;
+
+        std::uint64_t bits_[4] = {};
+        // Bit h of lo_[l] is set when byte 0xhl is in the set, for h < 8. hi_ does the same for h >= 8.
+        std::uint8_t lo_[16] = {};
+        std::uint8_t hi_[16] = {};
+    };
+
+} // namespace rubr::strng
+
+#endif
@@ -0,0 +1,251 @@
+#include <rubr/platform.h>
+#include <rubr/strng/Needle.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace rubr::strng {
+
+    namespace {
+        // Rough frequency of a byte in paths and source text: higher values are more common
+        unsigned int rank(char ch)
+        {
+            switch (ch)
+            {
+                case '/':
+                case '.':
+                case ' ':
+                case '\n':
+                case 'e':
+                case 't':
+                case 'a':
+                case 'o':
+                case 'i':
+                case 'n':
+                case 's':
+                case 'r': return 4;
+            }
+            if (ch >= 'a' && ch <= 'z')
+                return 3;
+            if ((ch >= '0' && ch <= '9') || ch == '_' || ch == '-')
+                return 2;
+            if (ch >= 'A' && ch <= 'Z')
+                return 1;
+            return 0;
+        }
+
+        bool is_letter(char ch)
+        {
+            return (ch | 0x20) >= 'a' && (ch | 0x20) <= 'z';
+        }
+        char to_lower(char ch)
+        {
+            return is_letter(ch) ? ch | 0x20 : ch;
+        }
+
+        // After this many false candidates, memchr() is not skipping enough anymore
+        constexpr std::size_t c_max_misses = 8;
+        // Minimal average distance between candidates to keep using memchr()
+        constexpr std::size_t c_min_skip = 32;
+    } // namespace
+
+    Needle::Needle(std::string_view needle, bool ignore_case)
+        : needle_(needle)
+    {
+        if (ignore_case && std::any_of(needle_.begin(), needle_.end(), is_letter))
+        {
+            kind_ = Kind::Fold;
+            for (auto &ch : needle_)
+                ch = to_lower(ch);
+        }
+        else if (needle_.size() <= 1)
+            kind_ = needle_.empty() ? Kind::Empty : Kind::Byte;
+        else
+            kind_ = Kind::Multi;
+
+        if (needle_.size() >= 2)
+        {
+            // The two rarest bytes, at different offsets
+            for (std::size_t ix = 0; ix < needle_.size(); ++ix)
+            {
+                if (rank(needle_[ix]) < rank(needle_[rare1_]))
+                    rare1_ = ix;
+            }
+            rare2_ = rare1_ == 0 ? 1 : 0;
+            for (std::size_t ix = 0; ix < needle_.size(); ++ix)
+            {
+                if (ix != rare1_ && (rank(needle_[ix]) < rank(needle_[rare2_]) || needle_[rare2_] == needle_[rare1_]))
+                    rare2_ = ix;
+            }
+        }
+    }
+
+    std::size_t Needle::find(std::string_view haystack, std::size_t pos) const
+    {
+        if (pos > haystack.size() || needle_.size() > haystack.size() - pos)
+            return npos;
+
+        switch (kind_)
+        {
+            case Kind::Empty: return pos;
+            case Kind::Byte:
+            {
+                const auto ptr = (const char *)std::memchr(haystack.data() + pos, needle_[0], haystack.size() - pos);
+                return ptr ? ptr - haystack.data() : npos;
+            }
+            case Kind::Multi: return find_multi_(haystack.data(), haystack.size(), pos);
+            case Kind::Fold: return find_fold_(haystack.data(), haystack.size(), pos);
+        }
+        return npos;
+    }
+
+    std::size_t Needle::find_multi_(const char *haystack, std::size_t size, std::size_t pos) const
+    {
+        const auto n = needle_.size();
+        const char byte1 = needle_[rare1_];
+        const char byte2 = needle_[rare2_];
+        // Last position where the needle can start
+        const auto end = size - n + 1;
+
+        auto verify = [&](std::size_t ix) {
+            return std::memcmp(haystack + ix, needle_.data(), n) == 0;
+        };
+
+        // As long as the rarest byte is rare in the haystack, memchr() skips fastest
+        const auto start = pos;
+        for (std::size_t misses = 0; pos < end;)
+        {
+            const auto ptr = (const char *)std::memchr(haystack + pos + rare1_, byte1, end - pos);
+            if (!ptr)
+                return npos;
+            const std::size_t ix = ptr - haystack - rare1_;
+            if (haystack[ix + rare2_] == byte2 && verify(ix))
+                return ix;
+            pos = ix + 1;
+            if (++misses >= c_max_misses && pos - start < c_min_skip * misses)
+                break;
+        }
+
+        // Too many candidates: compare both rare bytes at 32 (AVX2) or 16 (SSE2) positions at once
+#if RUBR_PLATFORM_SIMD_AVX2
+        {
+            const __m256i v1 = _mm256_set1_epi8(byte1);
+            const __m256i v2 = _mm256_set1_epi8(byte2);
+            for (; pos + 32 <= end; pos += 32)
+            {
+                const __m256i block1 = _mm256_loadu_si256((const __m256i *)(haystack + pos + rare1_));
+                const __m256i block2 = _mm256_loadu_si256((const __m256i *)(haystack + pos + rare2_));
+                const __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(v1, block1), _mm256_cmpeq_epi8(v2, block2));
+                for (auto mask = (std::uint32_t)_mm256_movemask_epi8(eq); mask; mask &= mask - 1)
+                {
+                    const auto ix = pos + std::countr_zero(mask);
+                    if (verify(ix))
+                        return ix;
+                }
+            }
+        }
+#endif
+#if RUBR_PLATFORM_SIMD_SSE2
+        {
+            const __m128i v1 = _mm_set1_epi8(byte1);
+            const __m128i v2 = _mm_set1_epi8(byte2);
+            for (; pos + 16 <= end; pos += 16)
+            {
+                const __m128i block1 = _mm_loadu_si128((const __m128i *)(haystack + pos + rare1_));
+                const __m128i block2 = _mm_loadu_si128((const __m128i *)(haystack + pos + rare2_));
+                const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(v1, block1), _mm_cmpeq_epi8(v2, block2));
+                for (auto mask = (std::uint32_t)_mm_movemask_epi8(eq); mask; mask &= mask - 1)
+                {
+                    const auto ix = pos + std::countr_zero(mask);
+                    if (verify(ix))
+                        return ix;
+                }
+            }
+        }
+#endif
+
+        // Remainder, or everything when no SIMD is available
+        for (; pos < end; ++pos)
+        {
+            if (haystack[pos + rare1_] == byte1 && haystack[pos + rare2_] == byte2 && verify(pos))
+                return pos;
+        }
+
+        return npos;
+    }
+
+    std::size_t Needle::find_fold_(const char *haystack, std::size_t size, std::size_t pos) const
+    {
+        const auto n = needle_.size();
+        const char byte1 = needle_[rare1_];
+        const char byte2 = needle_[rare2_];
+        // Setting bit 0x20 maps uppercase letters onto lowercase and leaves other bytes that can match unchanged
+        const char fold1 = is_letter(byte1) ? 0x20 : 0;
+        const char fold2 = is_letter(byte2) ? 0x20 : 0;
+        // Last position where the needle can start
+        const auto end = size - n + 1;
+
+        auto verify = [&](std::size_t ix) {
+            for (std::size_t offset = 0; offset < n; ++offset)
+            {
+                if (to_lower(haystack[ix + offset]) != needle_[offset])
+                    return false;
+            }
+            return true;
+        };
+
+        // memchr() cannot fold, the SIMD compare is used from the start
+#if RUBR_PLATFORM_SIMD_AVX2
+        {
+            const __m256i v1 = _mm256_set1_epi8(byte1);
+            const __m256i v2 = _mm256_set1_epi8(byte2);
+            const __m256i f1 = _mm256_set1_epi8(fold1);
+            const __m256i f2 = _mm256_set1_epi8(fold2);
+            for (; pos + 32 <= end; pos += 32)
+            {
+                const __m256i block1 = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(haystack + pos + rare1_)), f1);
+                const __m256i block2 = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(haystack + pos + rare2_)), f2);
+                const __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(v1, block1), _mm256_cmpeq_epi8(v2, block2));
+                for (auto mask = (std::uint32_t)_mm256_movemask_epi8(eq); mask; mask &= mask - 1)
+                {
+                    const auto ix = pos + std::countr_zero(mask);
+                    if (verify(ix))
+                        return ix;
+                }
+            }
+        }
+#endif
+#if RUBR_PLATFORM_SIMD_SSE2
+        {
+            const __m128i v1 = _mm_set1_epi8(byte1);
+            const __m128i v2 = _mm_set1_epi8(byte2);
+            const __m128i f1 = _mm_set1_epi8(fold1);
+            const __m128i f2 = _mm_set1_epi8(fold2);
+            for (; pos + 16 <= end; pos += 16)
+            {
+                const __m128i block1 = _mm_or_si128(_mm_loadu_si128((const __m128i *)(haystack + pos + rare1_)), f1);
+                const __m128i block2 = _mm_or_si128(_mm_loadu_si128((const __m128i *)(haystack + pos + rare2_)), f2);
+                const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(v1, block1), _mm_cmpeq_epi8(v2, block2));
+                for (auto mask = (std::uint32_t)_mm_movemask_epi8(eq); mask; mask &= mask - 1)
+                {
+                    const auto ix = pos + std::countr_zero(mask);
+                    if (verify(ix))
+                        return ix;
+                }
+            }
+        }
+#endif
+
+        // Remainder, or everything when no SIMD is available
+        for (; pos < end; ++pos)
+        {
+            if ((haystack[pos + rare1_] | fold1) == byte1 && (haystack[pos + rare2_] | fold2) == byte2 && verify(pos))
+                return pos;
+        }
+
+        return npos;
+    }
+
+} // namespace rubr::strng
@@ -0,0 +1,54 @@
+#ifndef HEADER_rubr_strng_Needle_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_strng_Needle_hpp_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace rubr::strng {
+
+    // Precompiled substring search, specialized on the size of the needle:
+    // - A single byte is searched for with memchr().
+    // - Longer needles are anchored on their two rarest bytes. As long as the rarest byte is rare in the haystack,
+    //   memchr() is used to skip ahead. When it produces too many false candidates, both bytes are compared
+    //   at 32 (AVX2) or 16 (SSE2) positions at once. Only candidates that match both are verified with memcmp().
+    // - With ignore_case, ASCII letters are folded by setting bit 0x20 of the haystack before comparing.
+    class Needle
+    {
+    public:
+        static constexpr std::size_t npos = std::string_view::npos;
+
+        Needle() {}
+        explicit Needle(std::string_view needle, bool ignore_case = false);
+
+        std::string_view str() const { return needle_; }
+        std::size_t size() const { return needle_.size(); }
+        bool empty() const { return needle_.empty(); }
+
+        // Same as std::string_view::find()
+        std::size_t find(std::string_view haystack, std::size_t pos = 0) const;
+
+    private:
+        enum class Kind
+        {
+            Empty,
+            Byte,
+            Multi,
+            // Contains an ASCII letter and ignores case
+            Fold,
+        };
+
+        std::size_t find_multi_(const char *haystack, std::size_t size, std::size_t pos) const;
+        std::size_t find_fold_(const char *haystack, std::size_t size, std::size_t pos) const;
+
+        // Lowercase for Kind::Fold
+        std::string needle_;
+        Kind kind_ = Kind::Empty;
+        // Offsets of the two rarest bytes in needle_
+        std::size_t rare1_ = 0;
+        std::size_t rare2_ = 0;
+    };
+
+} // namespace rubr::strng
+
+#endif
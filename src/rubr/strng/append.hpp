@@ -0,0 +1,32 @@
+#ifndef HEADER_rubr_strng_append_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_strng_append_hpp_ALREADY_INCLUDED
+
+#include <concepts>
+#include <string>
+#include <string_view>
+
+namespace rubr::strng {
+
+    // Counterpart of parse::Strange::pop_lsb()
+    template<std::integral T>
+    void append_lsb(std::string &dst, T v)
+    {
+        for (unsigned int i = 0; i < sizeof(v); ++i)
+        {
+            dst.push_back((char)(v & 0xff));
+            if constexpr (sizeof(v) > 1)
+                v >>= 8;
+        }
+    }
+
+    // Size as lsb, followed by the content
+    template<std::integral Size>
+    void append_sized(std::string &dst, std::string_view sv)
+    {
+        append_lsb(dst, (Size)sv.size());
+        dst.append(sv);
+    }
+
+} // namespace rubr::strng
+
+#endif
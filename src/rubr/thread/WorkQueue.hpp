@@ -0,0 +1,139 @@
+#ifndef HEADER_rubr_thread_WorkQueue_hpp_ALREADY_INCLUDED
+#define HEADER_rubr_thread_WorkQueue_hpp_ALREADY_INCLUDED
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace rubr::thread {
+
+    // Work-stealing queue: each worker pushes to and pops from the back of its own deque,
+    // and steals from the front of the others when its own deque is empty.
+    // Work is considered done when all pushed tasks are marked done().
+    template<typename Task>
+    class WorkQueue
+    {
+    public:
+        WorkQueue(std::size_t worker_count)
+            : worker_count_(worker_count), deques_(new Deque[worker_count]) {}
+
+        std::size_t worker_count() const { return worker_count_; }
+
+        void push(std::size_t worker_ix, Task &&task)
+        {
+            assert(worker_ix < worker_count_);
+            // Count before publishing to ensure pending_ cannot drop to zero while this task is in flight
+            ++pending_;
+            ++queued_;
+            {
+                auto &deque = deques_[worker_ix];
+                std::lock_guard<std::mutex> lock{deque.mutex};
+                deque.tasks.push_back(std::move(task));
+            }
+            notify_(false);
+        }
+
+        // Blocks until a task is available, all work is done or stop() was called
+        bool pop(std::size_t worker_ix, Task &task)
+        {
+            assert(worker_ix < worker_count_);
+            while (true)
+            {
+                if (stopped_)
+                    return false;
+
+                if (try_pop_(worker_ix, task))
+                    return true;
+
+                std::unique_lock<std::mutex> lock{idle_mutex_};
+                idle_cv_.wait(lock, [&]() { return stopped_ || queued_ > 0 || pending_ == 0; });
+                if (pending_ == 0)
+                    return false;
+            }
+        }
+
+        // Must be called once for each popped task, after all its subtasks are pushed
+        void done()
+        {
+            if (--pending_ == 0)
+                notify_(true);
+        }
+
+        void stop()
+        {
+            stopped_ = true;
+            notify_(true);
+        }
+
+    private:
+        struct Deque
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        bool try_pop_(std::size_t worker_ix, Task &task)
+        {
+            if (queued_ == 0)
+                return false;
+
+            // Depth-first on our own deque keeps the working set small
+            {
+                auto &deque = deques_[worker_ix];
+                std::lock_guard<std::mutex> lock{deque.mutex};
+                if (!deque.tasks.empty())
+                {
+                    task = std::move(deque.tasks.back());
+                    deque.tasks.pop_back();
+                    --queued_;
+                    return true;
+                }
+            }
+
+            // Stealing from the front takes the oldest, and hence typically largest, subtrees
+            for (std::size_t offset = 1; offset < worker_count_; ++offset)
+            {
+                auto &deque = deques_[(worker_ix + offset) % worker_count_];
+                std::lock_guard<std::mutex> lock{deque.mutex};
+                if (!deque.tasks.empty())
+                {
+                    task = std::move(deque.tasks.front());
+                    deque.tasks.pop_front();
+                    --queued_;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void notify_(bool all)
+        {
+            // Taking the lock avoids a lost wakeup between a waiter's predicate check and its wait()
+            {
+                std::lock_guard<std::mutex> lock{idle_mutex_};
+            }
+            if (all)
+                idle_cv_.notify_all();
+            else
+                idle_cv_.notify_one();
+        }
+
+        const std::size_t worker_count_;
+        std::unique_ptr<Deque[]> deques_;
+
+        std::atomic<std::size_t> pending_{0};
+        std::atomic<std::size_t> queued_{0};
+        std::atomic<bool> stopped_{false};
+
+        std::mutex idle_mutex_;
+        std::condition_variable idle_cv_;
+    };
+
+} // namespace rubr::thread
+
+#endif
@@ -0,0 +1,268 @@
+#include <rubr/fs/Walker.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace rubr;
+
+namespace {
+    // Small tree with a nested '.gitignore' and a hidden folder
+    std::filesystem::path create_tree()
+    {
+        const auto basedir = std::filesystem::temp_directory_path() / "rubr_fs_Walker_tests";
+        std::filesystem::remove_all(basedir);
+        for (const auto &subdir : {"a/b", "a/build", "c", ".hidden"})
+            std::filesystem::create_directories(basedir / subdir);
+        for (const auto &fn : {"root.txt", "a/a.txt", "a/a.o", "a/b/b.txt", "a/build/x.txt", "c/c.txt", ".hidden/h.txt"})
+            std::ofstream{basedir / fn} << fn;
+        std::ofstream{basedir / "a/.gitignore"} << "*.o\n/build\n";
+        return basedir;
+    }
+
+    std::vector<std::string> walk(fs::Walker &walker, const fs::Walker::Config &config)
+    {
+        std::vector<std::string> relpaths;
+        std::mutex mutex;
+        const bool ok = walker([&](const std::filesystem::path &fp) {
+            std::lock_guard<std::mutex> lock{mutex};
+            relpaths.push_back(std::filesystem::relative(fp, config.basedir).native());
+            return true;
+        });
+        REQUIRE(ok);
+        std::sort(relpaths.begin(), relpaths.end());
+        return relpaths;
+    }
+    std::vector<std::string> walk(const fs::Walker::Config &config)
+    {
+        fs::Walker walker{config};
+        return walk(walker, config);
+    }
+} // namespace
+
+TEST_CASE("backends", "[ut][fs][Walker]")
+{
+    fs::Walker::Config config;
+    config.basedir = create_tree();
+
+    const std::vector<std::string> exp = {"a/a.txt", "a/b/b.txt", "c/c.txt", "root.txt"};
+
+    SECTION("std")
+    {
+        config.backend = fs::Backend::Std;
+        REQUIRE(walk(config) == exp);
+    }
+    SECTION("getdents")
+    {
+        config.backend = fs::Backend::Getdents;
+        REQUIRE(walk(config) == exp);
+    }
+    SECTION("parallel")
+    {
+        config.thread_count = 4;
+        SECTION("std") { config.backend = fs::Backend::Std; }
+        SECTION("getdents") { config.backend = fs::Backend::Getdents; }
+        REQUIRE(walk(config) == exp);
+    }
+
+    std::filesystem::remove_all(config.basedir);
+}
+
+TEST_CASE("offsets", "[ut][fs][Walker]")
+{
+    fs::Walker::Config config;
+    config.basedir = create_tree();
+    config.backend = fs::Backend::Getdents;
+
+    std::vector<std::string> relpaths;
+    fs::Walker walker{config};
+    const bool ok = walker([&](std::string_view path, const fs::Walker::Offsets &offsets) {
+        REQUIRE(path.substr(0, offsets.base) == config.basedir.native() + "/");
+        REQUIRE(path.find('/', offsets.name) == std::string_view::npos);
+        REQUIRE(path[offsets.name - 1] == '/');
+        relpaths.emplace_back(path.substr(offsets.base));
+        return true;
+    });
+    REQUIRE(ok);
+    std::sort(relpaths.begin(), relpaths.end());
+    REQUIRE(relpaths == std::vector<std::string>{"a/a.txt", "a/b/b.txt", "c/c.txt", "root.txt"});
+
+    std::filesystem::remove_all(config.basedir);
+}
+
+TEST_CASE("nested ignore", "[ut][fs][Walker]")
+{
+    fs::Walker::Config config;
+    config.basedir = create_tree();
+    // Rules of a parent still apply when a subfolder has its own '.gitignore', and can be overruled there
+    std::ofstream{config.basedir / ".gitignore"} << "*.txt\n";
+    std::ofstream{config.basedir / "a/.gitignore"} << "*.o\n!a.txt\n";
+    std::ofstream{config.basedir / "a/b/.gitignore"} << "!*.o\n";
+    std::ofstream{config.basedir / "a/b/b.o"} << "b";
+
+    const std::vector<std::string> exp = {"a/a.txt", "a/b/b.o"};
+    SECTION("std") {}
+    SECTION("index")
+    {
+        config.index = config.basedir.native() + ".index";
+        std::filesystem::remove(config.index);
+        fs::Walker walker{config};
+        REQUIRE(walk(walker, config) == exp);
+        REQUIRE(walker.replay_count() == 0);
+        // All folders are replayed: the root, 'a', 'a/b', 'a/build' and 'c'
+        REQUIRE(walk(walker, config) == exp);
+        REQUIRE(walker.replay_count() == 5);
+    }
+    SECTION("decision cache")
+    {
+        config.decision_cache_capacity = 64;
+        REQUIRE(walk(config) == exp);
+    }
+    SECTION("ignore cache")
+    {
+        config.ignore_cache = config.basedir.native() + ".ignore_cache";
+        std::filesystem::remove(config.ignore_cache);
+        fs::Walker walker{config};
+        REQUIRE(walk(walker, config) == exp);
+        REQUIRE(walker.ignore_cache_hit_count() == 0);
+        // The '.gitignore' files in the root, 'a' and 'a/b'
+        REQUIRE(walk(walker, config) == exp);
+        REQUIRE(walker.ignore_cache_hit_count() == 3);
+    }
+    REQUIRE(walk(config) == exp);
+
+    if (!config.index.empty())
+        std::filesystem::remove(config.index);
+    if (!config.ignore_cache.empty())
+        std::filesystem::remove(config.ignore_cache);
+    std::filesystem::remove_all(config.basedir);
+}
+
+TEST_CASE("pruning", "[ut][fs][Walker]")
+{
+    fs::Walker::Config config;
+    config.basedir = create_tree();
+    std::filesystem::create_directories(config.basedir / "c/node_modules/x");
+    std::ofstream{config.basedir / "c/node_modules/x/x.txt"} << "x";
+    std::ofstream{config.basedir / ".gitignore"} << "node_modules/\n";
+
+    std::vector<std::string> entered;
+    fs::Walker walker{config};
+    REQUIRE(walker([&](std::string_view path, const fs::Walker::Offsets &offsets, fs::Walker::Kind kind) {
+        if (kind == fs::Walker::Kind::Enter)
+            entered.emplace_back(path.substr(offsets.base));
+        return true;
+    }));
+    std::sort(entered.begin(), entered.end());
+    // 'node_modules' itself does not match 'node_modules/', but it only contains ignored paths and is not entered
+    REQUIRE(entered == std::vector<std::string>{"", "a", "a/b", "c"});
+
+    std::filesystem::remove_all(config.basedir);
+}
+
+TEST_CASE("events", "[ut][fs][Walker]")
+{
+    fs::Walker::Config config;
+    config.basedir = create_tree();
+
+    std::vector<std::string> events;
+    std::mutex mutex;
+    auto ftor = [&](std::string_view path, const fs::Walker::Offsets &offsets, fs::Walker::Kind kind) {
+        const std::string relpath{path.substr(offsets.base)};
+        std::lock_guard<std::mutex> lock{mutex};
+        switch (kind)
+        {
+            case fs::Walker::Kind::Enter:
+                if (relpath == "a/b")
+                    return fs::Walker::Result::Skip;
+                events.push_back("enter " + relpath);
+                break;
+            case fs::Walker::Kind::Leave: events.push_back("leave " + relpath); break;
+            case fs::Walker::Kind::File: events.push_back("file " + relpath); break;
+        }
+        return fs::Walker::Result::Ok;
+    };
+
+    SECTION("sequential")
+    {
+        fs::Walker walker{config};
+        REQUIRE(walker(ftor) == fs::Walker::Result::Ok);
+
+        // Leave comes after all entries of a folder, including its subfolders
+        REQUIRE(events.front() == "enter ");
+        REQUIRE(events.back() == "leave ");
+        const auto enter_a = std::find(events.begin(), events.end(), "enter a");
+        const auto leave_a = std::find(events.begin(), events.end(), "leave a");
+        REQUIRE(enter_a < leave_a);
+        REQUIRE(std::find(enter_a, leave_a, "file a/a.txt") != leave_a);
+    }
+    SECTION("parallel")
+    {
+        config.thread_count = 4;
+        fs::Walker walker{config};
+        REQUIRE(walker(ftor) == fs::Walker::Result::Ok);
+    }
+
+    std::sort(events.begin(), events.end());
+    const std::vector<std::string> exp = {"enter ", "enter a", "enter c", "file a/a.txt", "file c/c.txt", "file root.txt", "leave ", "leave a", "leave c"};
+    REQUIRE(events == exp);
+
+    std::filesystem::remove_all(config.basedir);
+}
+
+TEST_CASE("deep", "[ut][fs][Walker]")
+{
+    fs::Walker::Config config;
+    config.basedir = std::filesystem::temp_directory_path() / "rubr_fs_Walker_tests_deep";
+    config.backend = fs::Backend::Getdents;
+    std::filesystem::remove_all(config.basedir);
+
+    std::string relpath;
+    for (auto i = 0u; i < 500; ++i)
+        relpath += "d/";
+    std::filesystem::create_directories(config.basedir / relpath);
+    relpath += "deep.txt";
+    std::ofstream{config.basedir / relpath} << "deep";
+
+    REQUIRE(walk(config) == std::vector<std::string>{relpath});
+
+    std::filesystem::remove_all(config.basedir);
+}
+
+TEST_CASE("index", "[ut][fs][Walker]")
+{
+    fs::Walker::Config config;
+    config.basedir = create_tree();
+    config.index = config.basedir.native() + ".index";
+    std::filesystem::remove(config.index);
+
+    std::vector<std::string> exp = {"a/a.txt", "a/b/b.txt", "c/c.txt", "root.txt"};
+
+    SECTION("cold and warm")
+    {
+        REQUIRE(walk(config) == exp);
+        REQUIRE(std::filesystem::exists(config.index));
+        REQUIRE(walk(config) == exp);
+    }
+    SECTION("changes")
+    {
+        REQUIRE(walk(config) == exp);
+
+        std::ofstream{config.basedir / "c/new.txt"} << "new";
+        exp.insert(exp.begin() + 3, "c/new.txt");
+        REQUIRE(walk(config) == exp);
+
+        std::ofstream{config.basedir / "a/.gitignore"} << "*.o\n";
+        exp.insert(exp.begin() + 2, "a/build/x.txt");
+        REQUIRE(walk(config) == exp);
+        REQUIRE(walk(config) == exp);
+    }
+
+    std::filesystem::remove(config.index);
+    std::filesystem::remove_all(config.basedir);
+}
@@ -0,0 +1,115 @@
+#include <rubr/fs/Watcher.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace rubr;
+
+namespace {
+    std::filesystem::path create_tree()
+    {
+        const auto basedir = std::filesystem::temp_directory_path() / "rubr_fs_Watcher_tests";
+        std::filesystem::remove_all(basedir);
+        for (const auto &subdir : {"a", "c", ".hidden"})
+            std::filesystem::create_directories(basedir / subdir);
+        for (const auto &fn : {"root.txt", "a/a.txt", "a/a.o", "c/c.txt", ".hidden/h.txt"})
+            std::ofstream{basedir / fn} << fn;
+        std::ofstream{basedir / "a/.gitignore"} << "*.o\n";
+        return basedir;
+    }
+
+    std::string to_string(const fs::Watcher::Event &event)
+    {
+        std::string str;
+        switch (event.kind)
+        {
+            case fs::Watcher::Kind::Create: str = "create "; break;
+            case fs::Watcher::Kind::Modify: str = "modify "; break;
+            case fs::Watcher::Kind::Delete: str = "delete "; break;
+            case fs::Watcher::Kind::MoveFrom: str = "move_from "; break;
+            case fs::Watcher::Kind::MoveTo: str = "move_to "; break;
+            case fs::Watcher::Kind::Rescan: str = "rescan "; break;
+        }
+        str += event.path.substr(event.offsets.base);
+        return str;
+    }
+
+    // Polls until no more events arrive
+    std::vector<std::string> poll(fs::Watcher &watcher)
+    {
+        std::vector<std::string> events;
+        bool found = true;
+        auto on_event = [&](const fs::Watcher::Event &event) {
+            found = true;
+            // Writing a file results in both a create and modify event
+            if (event.kind != fs::Watcher::Kind::Modify)
+                events.push_back(to_string(event));
+            return true;
+        };
+        while (found)
+        {
+            found = false;
+            REQUIRE(watcher.poll(on_event, 100));
+        }
+        // A file in a new folder can be reported by both the walk of the folder and its own event
+        std::sort(events.begin(), events.end());
+        events.erase(std::unique(events.begin(), events.end()), events.end());
+        return events;
+    }
+} // namespace
+
+TEST_CASE("Watcher", "[ut][fs][Watcher]")
+{
+    fs::Watcher::Config config;
+    config.basedir = create_tree();
+    config.backend = fs::Backend::Getdents;
+
+    fs::Watcher watcher{config};
+    std::vector<std::string> events;
+    REQUIRE(watcher.start([&](const fs::Watcher::Event &event) {
+        events.push_back(to_string(event));
+        return true;
+    }));
+    std::sort(events.begin(), events.end());
+    REQUIRE(events == std::vector<std::string>{"create a/a.txt", "create c/c.txt", "create root.txt"});
+
+    SECTION("files")
+    {
+        for (const auto &fn : {"c/new.txt", "a/new.o", ".hidden/new.txt"})
+            std::ofstream{config.basedir / fn} << fn;
+        std::filesystem::rename(config.basedir / "root.txt", config.basedir / "c/root.txt");
+        std::filesystem::remove(config.basedir / "a/a.txt");
+        REQUIRE(poll(watcher) == std::vector<std::string>{"create c/new.txt", "delete a/a.txt", "move_from root.txt", "move_to c/root.txt"});
+    }
+    SECTION("folders")
+    {
+        std::filesystem::create_directories(config.basedir / "d/e");
+        std::ofstream{config.basedir / "d/e/e.txt"} << "e";
+        std::ofstream{config.basedir / "d/e/e.o"} << "e";
+        REQUIRE(poll(watcher) == std::vector<std::string>{"create d/e/e.o", "create d/e/e.txt"});
+
+        // The new folder is watched as well
+        std::ofstream{config.basedir / "d/e/new.txt"} << "new";
+        REQUIRE(poll(watcher) == std::vector<std::string>{"create d/e/new.txt"});
+
+        std::filesystem::remove_all(config.basedir / "d");
+        const auto exp = std::vector<std::string>{"delete d", "delete d/e", "delete d/e/e.o", "delete d/e/e.txt", "delete d/e/new.txt"};
+        REQUIRE(poll(watcher) == exp);
+    }
+    SECTION("gitignore")
+    {
+        std::ofstream{config.basedir / "a/.gitignore"} << "*.txt\n";
+        REQUIRE(poll(watcher) == std::vector<std::string>{"create a/a.o", "rescan a"});
+
+        std::ofstream{config.basedir / "a/b.txt"} << "b";
+        std::ofstream{config.basedir / "a/b.o"} << "b";
+        REQUIRE(poll(watcher) == std::vector<std::string>{"create a/b.o"});
+    }
+
+    std::filesystem::remove_all(config.basedir);
+}
@@ -0,0 +1,143 @@
+#include <rubr/glob/DecisionCache.hpp>
+#include <rubr/glob/IgnoreStack.hpp>
+#include <rubr/profile/Stopwatch.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace rubr;
+
+TEST_CASE("DecisionCache", "[ut][glob][DecisionCache]")
+{
+    glob::DecisionCache cache{16};
+    REQUIRE(cache.capacity() == 16);
+
+    glob::Ignore ignore;
+    const std::vector<std::string> fps = {"a.o", "dir/a.o", "dir/b.o", "keep.o", "dir/keep.o", "a.cpp", "build", "dir/build", "dir/build/x"};
+
+    auto check = [&]() {
+        for (const auto &fp : fps)
+        {
+            REQUIRE(cache.match(ignore, fp) == ignore.match(fp));
+            REQUIRE(cache(ignore, fp, fp.rfind('/') + 1) == ignore(fp));
+        }
+    };
+
+    SECTION("empty")
+    {
+        REQUIRE(ignore.id() == 0);
+        REQUIRE(!cache(ignore, "a.o"));
+        REQUIRE(cache.hit_count() + cache.miss_count() == 0);
+    }
+    SECTION("name only")
+    {
+        REQUIRE(ignore.load_from_content("*.o\n!keep.o\nbuild\n"));
+        REQUIRE(ignore.name_only());
+        check();
+        check();
+        REQUIRE(cache.hit_count() > cache.miss_count());
+
+        // The same name in another folder is a hit
+        const auto hit_count = cache.hit_count();
+        REQUIRE(cache(ignore, "other/dir/a.o"));
+        REQUIRE(cache.hit_count() == hit_count + 1);
+    }
+    SECTION("path")
+    {
+        REQUIRE(ignore.load_from_content("*.o\n/dir/a.o\n!dir/keep.o\nbuild/\n"));
+        REQUIRE(!ignore.name_only());
+        check();
+        check();
+    }
+    SECTION("inner double star")
+    {
+        // A '**' after the front matches across '/': the decision depends on more than the name
+        for (const auto &content : {"foo**bar\n", "a**\n"})
+        {
+            INFO(content);
+            glob::Ignore other;
+            REQUIRE(other.load_from_content(content));
+            REQUIRE(!other.name_only());
+        }
+
+        REQUIRE(ignore.load_from_content("foo**bar\n"));
+        REQUIRE(ignore("xfoo/ybar"));
+        REQUIRE(!ignore("zz/ybar"));
+        REQUIRE(cache(ignore, "xfoo/ybar"));
+        REQUIRE(!cache(ignore, "zz/ybar"));
+
+        glob::IgnoreStack stack;
+        stack.push(ignore, 0);
+        REQUIRE(stack("xfoo/ybar", 5, &cache));
+        REQUIRE(!stack("zz/ybar", 3, &cache));
+    }
+    SECTION("reload")
+    {
+        REQUIRE(ignore.load_from_content("*.o\n"));
+        const auto id = ignore.id();
+        REQUIRE(cache(ignore, "a.o"));
+
+        glob::Ignore copy = ignore;
+        REQUIRE(copy.id() == id);
+        REQUIRE(cache(copy, "a.o"));
+        REQUIRE(cache.hit_count() == 1);
+
+        REQUIRE(ignore.load_from_content("!a.o\n"));
+        REQUIRE(ignore.id() != id);
+        REQUIRE(!cache(ignore, "a.o"));
+        REQUIRE(cache.miss_count() == 2);
+    }
+    SECTION("stack")
+    {
+        // Only the name-only level is cached
+        glob::Ignore outer, inner;
+        REQUIRE(outer.load_from_content("/dir/build\n"));
+        REQUIRE(inner.load_from_content("*.o\n!keep.o\n"));
+        glob::IgnoreStack stack;
+        stack.push(outer, 0);
+        stack.push(inner, 4);
+        for (const auto &path : {"dir/build", "dir/a.o", "dir/keep.o", "dir/a.cpp", "dir/sub/a.o"})
+        {
+            const std::string_view sv{path};
+            REQUIRE(stack(sv, sv.rfind('/') + 1, &cache) == stack(sv));
+        }
+        REQUIRE(cache.miss_count() == 4);
+        REQUIRE(cache.hit_count() == 1);
+
+        cache.clear();
+        REQUIRE(cache.hit_count() + cache.miss_count() == 0);
+    }
+}
+
+TEST_CASE("DecisionCache benchmark", "[.][bm][glob][DecisionCache]")
+{
+    // Rules of a typical C++ project, against a tree where the same names occur in many folders
+    glob::Ignore ignore;
+    std::string content = "*.o\n*.d\n*.a\nCMakeFiles\n*.log\n!keep.log\n.cache\n";
+    for (auto i = 0; i < 20; ++i)
+        content += "*.gen" + std::to_string(i) + "\n";
+    REQUIRE(ignore.load_from_content(content));
+    REQUIRE(ignore.name_only());
+
+    std::vector<std::string> paths;
+    for (auto i = 0; i < 50000; ++i)
+        paths.push_back("dir" + std::to_string(i % 100) + "/file" + std::to_string(i % 50) + (i % 2 ? ".cpp" : ".o"));
+
+    const auto n = 10;
+    for (const auto &[name, use_cache] : {std::pair{"Ignore", false}, {"DecisionCache", true}})
+    {
+        glob::DecisionCache cache;
+        profile::Stopwatch sw;
+        std::size_t count = 0;
+        for (auto i = 0; i < n; ++i)
+        {
+            for (const auto &path : paths)
+                count += use_cache ? cache(ignore, path) : ignore(path);
+        }
+        REQUIRE(count == n * paths.size() / 2);
+        std::cout << name << ": " << sw.elapse<std::chrono::nanoseconds>().count() / n / paths.size() << "ns per path" << std::endl;
+    }
+}
@@ -0,0 +1,113 @@
+#include <rubr/glob/GlobSet.hpp>
+#include <rubr/profile/Stopwatch.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace rubr;
+
+namespace {
+    // Index of the last glob that matches str, the reference for GlobSet::match()
+    std::size_t match_linear(const std::deque<glob::Glob> &globs, const std::string &str)
+    {
+        for (auto ix = globs.size(); ix-- > 0;)
+        {
+            if (globs[ix](str))
+                return ix;
+        }
+        return glob::GlobSet::npos;
+    }
+} // namespace
+
+TEST_CASE("GlobSet", "[ut][glob][GlobSet]")
+{
+    std::deque<glob::Glob> globs;
+    glob::GlobSet set;
+
+    SECTION("empty")
+    {
+        set.build();
+        REQUIRE(set.match("abc") == glob::GlobSet::npos);
+    }
+    SECTION("kinds")
+    {
+        using W = glob::Wildcard;
+        for (const auto &[front, pattern, back] : {std::tuple{W::Nothing, "build", W::Nothing}, {W::All, ".o", W::Nothing}, {W::Nothing, "doc/", W::All}, {W::All, "*.txt", W::Nothing}, {W::All, "tmp", W::All}, {W::Nothing, "", W::Nothing}})
+            globs.emplace_back(glob::Glob::Config{.front = front, .pattern = pattern, .back = back});
+        for (const auto &glob : globs)
+            set.add(glob);
+        set.build();
+
+        REQUIRE(set.match("build") == 0);
+        REQUIRE(set.match("a/b.o") == 1);
+        REQUIRE(set.match("doc/a") == 2);
+        REQUIRE(set.match("a/b.txt") == 3);
+        REQUIRE(set.match("a/tmp/b") == 4);
+        REQUIRE(set.match("a/tmp/b.txt") == 4);
+        REQUIRE(set.match("") == 5);
+        REQUIRE(set.match("abc") == glob::GlobSet::npos);
+    }
+    SECTION("random")
+    {
+        std::mt19937 rng{42};
+        const std::string alphabet = "ab./A*?";
+        auto random_str = [&](std::size_t max_size, std::size_t alphabet_size) {
+            std::string str(rng() % (max_size + 1), ' ');
+            for (auto &ch : str)
+                ch = alphabet[rng() % alphabet_size];
+            return str;
+        };
+
+        for (auto i = 0; i < 200; ++i)
+            globs.emplace_back(glob::Glob::Config{.front = glob::Wildcard(rng() % 3), .pattern = random_str(6, 7), .back = glob::Wildcard(rng() % 3), .ignore_case = rng() % 4 == 0});
+        for (const auto &glob : globs)
+            set.add(glob);
+        set.build();
+
+        for (auto i = 0; i < 5000; ++i)
+        {
+            const auto str = random_str(10, 5);
+            REQUIRE(set.match(str) == match_linear(globs, str));
+        }
+    }
+}
+
+TEST_CASE("GlobSet benchmark", "[.][bm][glob][GlobSet]")
+{
+    // Similar to a generated '.gitignore'
+    std::deque<glob::Glob> globs;
+    for (auto i = 0; i < 1000; ++i)
+    {
+        const auto name = "gen" + std::to_string(i);
+        switch (i % 4)
+        {
+            case 0: globs.emplace_back(glob::Glob::Config{.front = glob::Wildcard::All, .pattern = "*." + name}); break;
+            case 1: globs.emplace_back(glob::Glob::Config{.front = glob::Wildcard::Nothing, .pattern = name + "/", .back = glob::Wildcard::All}); break;
+            case 2: globs.emplace_back(glob::Glob::Config{.front = glob::Wildcard::All, .pattern = name + "/*.o"}); break;
+            case 3: globs.emplace_back(glob::Glob::Config{.front = glob::Wildcard::All, .pattern = "/" + name}); break;
+        }
+    }
+    glob::GlobSet set;
+    for (const auto &glob : globs)
+        set.add(glob);
+    set.build();
+
+    const std::vector<std::string> paths = {"src/rubr/glob/GlobSet.cpp", "gen41/a/b.txt", "a/gen42/b.o", "a/b/c/gen43", "x/y.gen400"};
+    const auto n = 1000;
+    for (const auto &[name, use_set] : {std::pair{"linear", false}, {"set", true}})
+    {
+        profile::Stopwatch sw;
+        std::size_t count = 0;
+        for (auto i = 0; i < n; ++i)
+        {
+            for (const auto &path : paths)
+                count += (use_set ? set.match(path) : match_linear(globs, path)) != glob::GlobSet::npos;
+        }
+        REQUIRE(count == n * 4);
+        std::cout << name << ": " << sw.elapse<std::chrono::nanoseconds>().count() / (n * paths.size()) << "ns per path" << std::endl;
+    }
+}
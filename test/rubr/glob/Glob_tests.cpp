@@ -1,8 +1,14 @@
 #include <rubr/debug/log.hpp>
 #include <rubr/glob/Glob.hpp>
+#include <rubr/profile/Stopwatch.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 using namespace rubr;
@@ -70,6 +76,70 @@ TEST_CASE("", "[ut][glob][Glob]")
         exp.ok.push_back("a/bacb");
         exp.ko.push_back("a/b");
     }
+    SECTION("question mark")
+    {
+        scn.config.pattern = "a?c";
+        exp.ok.push_back("abc");
+        exp.ok.push_back("a.c");
+        exp.ko.push_back("a/c");
+        exp.ko.push_back("ac");
+        exp.ko.push_back("abbc");
+    }
+    SECTION("bracket expression")
+    {
+        scn.config.pattern = "[a-c]x[!0-9]";
+        exp.ok.push_back("axz");
+        exp.ok.push_back("cx_");
+        exp.ko.push_back("dxz");
+        exp.ko.push_back("ax5");
+        exp.ko.push_back("ax/");
+    }
+    SECTION("bracket edge cases")
+    {
+        SECTION("unclosed")
+        {
+            scn.config.pattern = "a[b";
+            exp.ok.push_back("a[b");
+            exp.ko.push_back("ab");
+        }
+        SECTION("star")
+        {
+            scn.config.pattern = "a[*]b";
+            exp.ok.push_back("a*b");
+            exp.ko.push_back("axb");
+        }
+        SECTION("closing bracket")
+        {
+            scn.config.pattern = "[]a]";
+            exp.ok.push_back("]");
+            exp.ok.push_back("a");
+            exp.ko.push_back("b");
+        }
+        SECTION("slash")
+        {
+            scn.config.pattern = "a[/]b";
+            exp.ko.push_back("a/b");
+        }
+    }
+    SECTION("ignore case")
+    {
+        scn.config.ignore_case = true;
+        SECTION("literal")
+        {
+            scn.config.pattern = "Readme*";
+            exp.ok.push_back("README.md");
+            exp.ok.push_back("readme");
+            exp.ko.push_back("read.me");
+        }
+        SECTION("bracket expression")
+        {
+            scn.config.pattern = "*.[!c]pp";
+            exp.ok.push_back("a.hpp");
+            exp.ok.push_back("a.HPP");
+            exp.ko.push_back("a.cpp");
+            exp.ko.push_back("a.CPP");
+        }
+    }
 
     glob::Glob glob{scn.config};
 
@@ -102,3 +172,285 @@ TEST_CASE("func", "[ut][glob][Wildcard][max]")
     REQUIRE(glob::max(W::All, W::Some) == W::All);
     REQUIRE(glob::max(W::All, W::All) == W::All);
 }
+
+TEST_CASE("below", "[ut][glob][Glob][below]")
+{
+    using B = glob::Below;
+    auto below = [](const std::string &pattern, glob::Wildcard front, glob::Wildcard back, const std::string &dir) {
+        glob::Glob glob{glob::Glob::Config{.front = front, .pattern = pattern, .back = back}};
+        return glob.below(dir);
+    };
+    using W = glob::Wildcard;
+
+    // '/build/' in a '.gitignore'
+    REQUIRE(below("build/", W::Nothing, W::All, "build") == B::All);
+    REQUIRE(below("build/", W::Nothing, W::All, "src") == B::None);
+    REQUIRE(below("build/", W::Nothing, W::All, "src/build") == B::None);
+    REQUIRE(below("build/", W::Nothing, W::All, "") == B::Some);
+
+    // 'node_modules/' in a '.gitignore'
+    REQUIRE(below("node_modules/", W::All, W::All, "a/node_modules") == B::All);
+    REQUIRE(below("node_modules/", W::All, W::All, "a/b") == B::Some);
+
+    // '/doc' in a '.gitignore'
+    REQUIRE(below("doc", W::Nothing, W::Nothing, "src") == B::None);
+    REQUIRE(below("doc", W::Nothing, W::Nothing, "doc") == B::None);
+
+    REQUIRE(below("*.o", W::All, W::Nothing, "src") == B::Some);
+    REQUIRE(below("*.o", W::Nothing, W::Nothing, "src") == B::None);
+    REQUIRE(below("src/*.o", W::Nothing, W::Nothing, "src") == B::Some);
+    REQUIRE(below("src/*.o", W::Nothing, W::Nothing, "src/a") == B::None);
+    REQUIRE(below("src/**", W::Nothing, W::Nothing, "src/a") == B::All);
+
+    // The analysis is consistent with matching
+    for (const auto &path : {"build/a", "build/a/b.o", "src/a.o", "src/a/b.o", "doc", "a/node_modules/x"})
+    {
+        for (const auto &[pattern, front, back] : {std::tuple{"build/", W::Nothing, W::All}, {"*.o", W::All, W::Nothing}, {"src/*.o", W::Nothing, W::Nothing}, {"node_modules/", W::All, W::All}})
+        {
+            glob::Glob glob{glob::Glob::Config{.front = front, .pattern = pattern, .back = back}};
+            const std::string_view sv{path};
+            for (auto ix = sv.find('/'); ix != std::string_view::npos; ix = sv.find('/', ix + 1))
+            {
+                const auto res = glob.below(sv.substr(0, ix));
+                if (res == B::None)
+                    REQUIRE(!glob(sv));
+                if (res == B::All)
+                    REQUIRE(glob(sv));
+            }
+        }
+    }
+}
+
+TEST_CASE("kind", "[ut][glob][Glob][kind]")
+{
+    using K = glob::Glob::Kind;
+    using W = glob::Wildcard;
+    auto kind = [](W front, const std::string &pattern, W back) {
+        return glob::Glob{glob::Glob::Config{.front = front, .pattern = pattern, .back = back}}.kind();
+    };
+
+    // How the rules of a '.gitignore' are compiled
+    REQUIRE(kind(W::Nothing, "build", W::Nothing) == K::Exact);
+    REQUIRE(kind(W::Nothing, "build/", W::All) == K::Prefix);
+    REQUIRE(kind(W::All, "*.log", W::Nothing) == K::Suffix);
+    REQUIRE(kind(W::All, "node_modules/", W::All) == K::Generic);
+    REQUIRE(kind(W::All, "cache*", W::Nothing) == K::Basename);
+    REQUIRE(kind(W::Nothing, "src/*.o", W::Nothing) == K::Generic);
+
+    REQUIRE(kind(W::Nothing, "*.log", W::Nothing) == K::Suffix);
+    REQUIRE(kind(W::Nothing, "*/a.log", W::Nothing) == K::Generic);
+    REQUIRE(kind(W::Nothing, "", W::All) == K::Generic);
+
+    SECTION("name offset")
+    {
+        const glob::Glob suffix{glob::Glob::Config{.pattern = "*.log"}};
+        REQUIRE(suffix("a.log", 0));
+        REQUIRE(!suffix("dir/a.log", 4));
+
+        const glob::Glob prefix{glob::Glob::Config{.pattern = "dir/a*"}};
+        REQUIRE(prefix("dir/abc", 4));
+        REQUIRE(!prefix("dir/abc/d", 8));
+
+        const glob::Glob basename{glob::Glob::Config{.front = W::All, .pattern = "cache*"}};
+        REQUIRE(basename("a/b/cache.txt", 4));
+        REQUIRE(basename("a/b/my_cache", 4));
+        REQUIRE(!basename("a/cache/b", 8));
+    }
+}
+
+TEST_CASE("batch", "[ut][glob][Glob][batch]")
+{
+    using W = glob::Wildcard;
+    const std::vector<std::string_view> strs = {"", "a.o", "dir/a.o", "a.obj", "o", ".o", "long/path/to/some/file.o", "build", "dir/build", "x.cpp"};
+    for (const auto &[front, pattern, back] : {std::tuple{W::All, "*.o", W::Nothing}, {W::All, "*.extension", W::Nothing}, {W::Nothing, "build", W::Nothing}, {W::Nothing, "dir/", W::All}, {W::All, "a*", W::Nothing}})
+    {
+        const glob::Glob glob{glob::Glob::Config{.front = front, .pattern = pattern, .back = back}};
+        glob::Mask mask;
+        glob(strs, mask);
+        REQUIRE(mask.size() == 1);
+        for (std::size_t ix = 0; ix < strs.size(); ++ix)
+            REQUIRE(glob::test(mask, ix) == glob(strs[ix]));
+    }
+}
+
+TEST_CASE("nfa", "[ut][glob][Glob][nfa]")
+{
+    // Random patterns and paths over a small alphabet, to hit many partial matches
+    std::mt19937 rng{42};
+    const std::string alphabet = "ab/A*?[]!-";
+    auto random_str = [&](std::size_t max_size, std::size_t alphabet_size) {
+        std::string str(rng() % (max_size + 1), ' ');
+        for (auto &ch : str)
+            ch = alphabet[rng() % alphabet_size];
+        return str;
+    };
+
+    using W = glob::Wildcard;
+    for (auto i = 0; i < 2000; ++i)
+    {
+        const glob::Glob glob{glob::Glob::Config{.front = W(rng() % 3), .pattern = random_str(8, 10), .back = W(rng() % 3), .ignore_case = rng() % 4 == 0}};
+        for (auto j = 0; j < 20; ++j)
+        {
+            const auto path = random_str(12, 4);
+            const auto exp = glob.match_backtrack(path);
+            REQUIRE(glob(path) == exp);
+            REQUIRE(glob(path, path.rfind('/') + 1) == exp);
+        }
+    }
+
+    SECTION("long pattern")
+    {
+        const glob::Glob glob{glob::Glob::Config{.front = W::All, .pattern = std::string(70, 'a') + "*b"}};
+        REQUIRE(glob("x/" + std::string(70, 'a') + "zzb"));
+        REQUIRE(!glob(std::string(70, 'a') + "/b"));
+    }
+}
+
+TEST_CASE("serialization", "[ut][glob][Glob][serialization]")
+{
+    // A deserialized Glob reuses the compiled parts and NFA, and must match exactly the same paths
+    std::mt19937 rng{42};
+    const std::string alphabet = "ab/A*?[]!-";
+    auto random_str = [&](std::size_t max_size, std::size_t alphabet_size) {
+        std::string str(rng() % (max_size + 1), ' ');
+        for (auto &ch : str)
+            ch = alphabet[rng() % alphabet_size];
+        return str;
+    };
+
+    using W = glob::Wildcard;
+    for (auto i = 0; i < 500; ++i)
+    {
+        const auto pattern = i == 0 ? std::string(70, 'a') + "*b" : random_str(8, 10);
+        const glob::Glob glob{glob::Glob::Config{.front = W(rng() % 3), .pattern = pattern, .back = W(rng() % 3), .ignore_case = rng() % 4 == 0}};
+        std::string str;
+        glob.write(str);
+
+        glob::Glob copy;
+        parse::Strange strange{str};
+        REQUIRE(copy.read(strange));
+        REQUIRE(strange.empty());
+        REQUIRE(copy.config().pattern == glob.config().pattern);
+        REQUIRE(copy.kind() == glob.kind());
+        for (auto j = 0; j < 20; ++j)
+        {
+            const auto path = random_str(12, 4);
+            REQUIRE(copy(path) == glob(path));
+        }
+
+        SECTION("truncated")
+        {
+            for (std::size_t size = 0; size < str.size(); ++size)
+            {
+                parse::Strange truncated{str.data(), size};
+                REQUIRE(!copy.read(truncated));
+            }
+        }
+    }
+
+    SECTION("too many byte classes")
+    {
+        // Bracket k holds the bytes b with bit k of b+1 set: each byte gets its own class, more than fit in a byte
+        std::string pattern;
+        for (unsigned int k = 0; k < 9; ++k)
+        {
+            std::string set;
+            bool dash = false;
+            for (unsigned int byte = 0; byte < 256; ++byte)
+            {
+                if (!((byte + 1) >> k & 1) || byte == '/')
+                    continue;
+                if (byte == ']')
+                    set.insert(set.begin(), ']');
+                else if (byte == '-')
+                    dash = true;
+                else if (byte != '!' && byte != '^')
+                    set.push_back((char)byte);
+                else
+                    // Not in front, where it would negate the set
+                    set.insert(set.begin() + std::min<std::size_t>(set.size(), 1), (char)byte);
+            }
+            if (dash)
+                set.push_back('-');
+            pattern += "[" + set + "]";
+        }
+        const glob::Glob glob{glob::Glob::Config{.front = W::All, .pattern = pattern}};
+        std::string str;
+        glob.write(str);
+
+        glob::Glob copy;
+        parse::Strange strange{str};
+        REQUIRE(copy.read(strange));
+        REQUIRE(strange.empty());
+        const auto match = std::string(8, '\xfe') + '\xff';
+        REQUIRE(copy("x/" + match));
+        for (const auto &path : {match, std::string(9, '\xff'), std::string(9, '\x01'), std::string("abcdefghi")})
+        {
+            REQUIRE(copy(path) == glob.match_backtrack(path));
+            REQUIRE(glob(path) == glob.match_backtrack(path));
+        }
+    }
+}
+
+TEST_CASE("serialization benchmark", "[.][bm][glob][Glob]")
+{
+    // Typical '.gitignore' rules, compiled from their pattern or read from their serialized form
+    std::vector<glob::Glob::Config> configs;
+    for (auto i = 0; i < 100; ++i)
+    {
+        const auto nr = std::to_string(i);
+        configs.push_back(glob::Glob::Config{.front = glob::Wildcard::All, .pattern = "*.ext" + nr});
+        configs.push_back(glob::Glob::Config{.pattern = "build" + nr + "/", .back = glob::Wildcard::All});
+        configs.push_back(glob::Glob::Config{.front = glob::Wildcard::All, .pattern = "src/**/gen" + nr + "_*.cpp"});
+    }
+    std::vector<std::string> blobs;
+    for (const auto &config : configs)
+        glob::Glob{config}.write(blobs.emplace_back());
+
+    const auto n = 100;
+    for (const auto &[name, use_read] : {std::pair{"compile", false}, {"read", true}})
+    {
+        glob::Glob glob;
+        profile::Stopwatch sw;
+        std::size_t count = 0;
+        for (auto i = 0; i < n; ++i)
+        {
+            for (std::size_t ix = 0; ix < configs.size(); ++ix)
+            {
+                if (use_read)
+                {
+                    parse::Strange strange{blobs[ix]};
+                    count += glob.read(strange);
+                }
+                else
+                {
+                    glob = glob::Glob{configs[ix]};
+                    count += glob.kind() != glob::Glob::Kind::Exact;
+                }
+            }
+        }
+        REQUIRE(count == n * configs.size());
+        std::cout << name << ": " << sw.elapse<std::chrono::nanoseconds>().count() / n / configs.size() << "ns per glob" << std::endl;
+    }
+}
+
+TEST_CASE("nfa benchmark", "[.][bm][glob][Glob]")
+{
+    // Repeated folder names make the backtracking matcher try every combination of split points
+    const glob::Glob glob{glob::Glob::Config{.front = glob::Wildcard::All, .pattern = "a/**/a/**/a/**/a/**/b"}};
+    std::string path;
+    for (auto i = 0; i < 40; ++i)
+        path += "a/";
+    path += "c";
+
+    for (const auto &[name, nfa] : {std::pair{"backtrack", false}, {"nfa", true}})
+    {
+        profile::Stopwatch sw;
+        std::size_t count = 0;
+        const auto n = nfa ? 100000 : 10;
+        for (auto i = 0; i < n; ++i)
+            count += nfa ? glob(path) : glob.match_backtrack(path);
+        REQUIRE(count == 0);
+        std::cout << name << ": " << sw.elapse<std::chrono::nanoseconds>().count() / n << "ns per match" << std::endl;
+    }
+}
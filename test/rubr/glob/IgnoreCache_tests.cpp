@@ -0,0 +1,89 @@
+#include <rubr/glob/IgnoreCache.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace rubr;
+
+TEST_CASE("IgnoreCache", "[ut][glob][IgnoreCache]")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "rubr_glob_IgnoreCache_tests";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const auto ignore_fp = dir / ".gitignore";
+    const auto cache_fp = dir / "cache";
+    std::ofstream{ignore_fp} << "*.log\n!keep.log\n/build\n";
+
+    // Loads ignore_fp via a fresh cache that is read from and written to cache_fp
+    auto load = [&](glob::Ignore &ignore, std::size_t &hit_count) {
+        glob::IgnoreCache cache;
+        REQUIRE(cache.load(cache_fp));
+        REQUIRE(cache.load_ignore(ignore, ignore_fp));
+        REQUIRE(cache.save(cache_fp));
+        hit_count = cache.hit_count();
+        REQUIRE(cache.hit_count() + cache.miss_count() == 1);
+    };
+
+    std::size_t hit_count;
+    glob::Ignore first;
+    load(first, hit_count);
+    REQUIRE(hit_count == 0);
+
+    SECTION("unchanged")
+    {
+        glob::Ignore second;
+        load(second, hit_count);
+        REQUIRE(hit_count == 1);
+        for (const auto &fp : {"a.log", "dir/a.log", "keep.log", "build", "dir/build", "a.txt"})
+            REQUIRE(second(fp) == first(fp));
+    }
+    SECTION("changed")
+    {
+        std::ofstream{ignore_fp} << "*.txt\n";
+        glob::Ignore second;
+        load(second, hit_count);
+        REQUIRE(hit_count == 0);
+        REQUIRE(second("a.txt"));
+        REQUIRE(!second("a.log"));
+    }
+    SECTION("corrupt cache")
+    {
+        std::ofstream{cache_fp} << "rubrIC01 garbage";
+        glob::Ignore second;
+        load(second, hit_count);
+        REQUIRE(hit_count == 0);
+        REQUIRE(second("a.log"));
+    }
+    SECTION("non-empty ignore")
+    {
+        // Cold and warm, the existing rules are replaced and not written to the cache
+        for (const auto warm : {false, true})
+        {
+            const auto fp = warm ? cache_fp : dir / "cold_cache";
+            glob::IgnoreCache cache;
+            REQUIRE(cache.load(fp));
+            glob::Ignore second;
+            REQUIRE(second.load_from_content("*.txt\n"));
+            REQUIRE(cache.load_ignore(second, ignore_fp));
+            REQUIRE(cache.save(fp));
+            REQUIRE(cache.hit_count() == (warm ? 1 : 0));
+            REQUIRE(second("a.log"));
+            REQUIRE(!second("a.txt"));
+        }
+        glob::Ignore third;
+        load(third, hit_count);
+        REQUIRE(hit_count == 1);
+        REQUIRE(!third("a.txt"));
+    }
+    SECTION("missing ignore file")
+    {
+        glob::IgnoreCache cache;
+        glob::Ignore ignore;
+        REQUIRE(!cache.load_ignore(ignore, dir / "missing"));
+    }
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,147 @@
+#include <rubr/glob/Ignore.hpp>
+#include <rubr/glob/IgnoreStack.hpp>
+#include <rubr/profile/Stopwatch.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <bit>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace rubr;
+
+TEST_CASE("Ignore", "[ut][glob][Ignore]")
+{
+    glob::Ignore ignore;
+
+    SECTION("last match wins")
+    {
+        REQUIRE(ignore.load_from_content("*.log\n!keep.log\n"));
+        REQUIRE(ignore("a.log"));
+        REQUIRE(ignore("dir/a.log"));
+        REQUIRE(!ignore("keep.log"));
+        REQUIRE(!ignore("dir/keep.log"));
+        REQUIRE(!ignore("a.txt"));
+    }
+    SECTION("ignore after include")
+    {
+        REQUIRE(ignore.load_from_content("!keep.log\n*.log\n"));
+        REQUIRE(ignore("a.log"));
+        REQUIRE(ignore("keep.log"));
+    }
+    SECTION("serialization")
+    {
+        REQUIRE(ignore.load_from_content("*.log\n!keep.log\n/build\n"));
+        std::string str;
+        ignore.write(str);
+
+        glob::Ignore copy;
+        parse::Strange strange{str};
+        REQUIRE(copy.read(strange));
+        REQUIRE(strange.empty());
+        for (const auto &fp : {"a.log", "keep.log", "build", "dir/build", "a.txt"})
+            REQUIRE(copy(fp) == ignore(fp));
+    }
+    SECTION("shared globs")
+    {
+        REQUIRE(ignore.load_from_content("*.log\n!keep.log\n"));
+        glob::Ignore other;
+        REQUIRE(other.load_from_content("# other\n*.log\n"));
+        REQUIRE(other.rules()[0].glob == ignore.rules()[0].glob);
+
+        const auto copy = ignore;
+        REQUIRE(copy.rules()[1].glob == ignore.rules()[1].glob);
+        REQUIRE(copy("a.log"));
+        REQUIRE(!copy("keep.log"));
+    }
+    SECTION("batch")
+    {
+        std::vector<std::string> paths;
+        for (auto i = 0; i < 150; ++i)
+            paths.push_back("dir" + std::to_string(i % 7) + "/file" + std::to_string(i) + (i % 3 ? ".log" : ".txt"));
+        paths.push_back("keep.log");
+        const std::vector<std::string_view> fps{paths.begin(), paths.end()};
+
+        auto check = [&]() {
+            glob::Mask mask;
+            ignore(fps, mask);
+            REQUIRE(mask.size() == 3);
+            for (std::size_t ix = 0; ix < fps.size(); ++ix)
+                REQUIRE(glob::test(mask, ix) == ignore(fps[ix]));
+        };
+
+        REQUIRE(ignore.load_from_content("*.log\n!keep.log\n/dir3\n!*5.log\n"));
+        check();
+
+        SECTION("many rules")
+        {
+            std::string content;
+            for (auto i = 0; i < 100; ++i)
+                content += "*.gen" + std::to_string(i) + "\n";
+            REQUIRE(ignore.load_from_content(content));
+            check();
+        }
+    }
+}
+
+TEST_CASE("Ignore benchmark", "[.][bm][glob][Ignore]")
+{
+    glob::Ignore ignore;
+    REQUIRE(ignore.load_from_content("*.o\n*.log\n/build/\n!keep.log\n"));
+
+    // A large folder
+    std::vector<std::string> paths;
+    for (auto i = 0; i < 50000; ++i)
+        paths.push_back("file" + std::to_string(i) + (i % 2 ? ".cpp" : ".o"));
+    const std::vector<std::string_view> fps{paths.begin(), paths.end()};
+
+    const auto n = 10;
+    for (const auto &[name, batch] : {std::pair{"single", false}, {"batch", true}})
+    {
+        profile::Stopwatch sw;
+        std::size_t count = 0;
+        for (auto i = 0; i < n; ++i)
+        {
+            if (batch)
+            {
+                glob::Mask mask;
+                ignore(fps, mask);
+                for (const auto word : mask)
+                    count += std::popcount(word);
+            }
+            else
+            {
+                for (const auto &fp : fps)
+                    count += ignore(fp);
+            }
+        }
+        REQUIRE(count == n * fps.size() / 2);
+        std::cout << name << ": " << sw.elapse<std::chrono::nanoseconds>().count() / n / fps.size() << "ns per path" << std::endl;
+    }
+}
+
+TEST_CASE("IgnoreStack", "[ut][glob][IgnoreStack]")
+{
+    glob::Ignore outer, inner;
+    REQUIRE(outer.load_from_content("*.log\n/tmp\n"));
+    REQUIRE(inner.load_from_content("!keep.log\n*.o\n"));
+
+    glob::IgnoreStack stack;
+    REQUIRE(stack.empty());
+    stack.push(outer, 5);
+    const auto outer_stack = stack;
+    stack.push(inner, 7);
+
+    // Rules of the outer level still apply below the inner level
+    REQUIRE(stack("root/a/a.log"));
+    REQUIRE(!stack("root/a/keep.log"));
+    REQUIRE(stack("root/a/a.o"));
+    REQUIRE(!stack("root/a/a.txt"));
+    // '/tmp' is anchored at the outer level
+    REQUIRE(stack("root/tmp"));
+    REQUIRE(!stack("root/a/tmp"));
+
+    REQUIRE(outer_stack("root/keep.log"));
+    REQUIRE(!outer_stack("root/a.o"));
+}
@@ -0,0 +1,53 @@
+#include <rubr/glob/Intern.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rubr;
+
+TEST_CASE("Intern", "[ut][glob][Intern]")
+{
+    using W = glob::Wildcard;
+    glob::Intern intern;
+
+    const auto &a = intern(W::All, "*.o", W::Nothing);
+    REQUIRE(intern.size() == 1);
+
+    // The pattern is copied, the caller's buffer can be reused
+    std::string pattern = "*.o";
+    REQUIRE(&intern(W::All, pattern, W::Nothing) == &a);
+    pattern = "*.a";
+    REQUIRE(&intern(W::All, "*.o", W::Nothing) == &a);
+    REQUIRE(intern.size() == 1);
+
+    // Each part of the config distinguishes globs
+    REQUIRE(&intern(W::Nothing, "*.o", W::Nothing) != &a);
+    REQUIRE(&intern(W::All, "*.o", W::All) != &a);
+    REQUIRE(&intern(W::All, "*.o", W::Nothing, true) != &a);
+    REQUIRE(&intern(glob::Glob::Config{.front = W::All, .pattern = "*.o"}) == &a);
+    REQUIRE(intern.size() == 4);
+
+    REQUIRE(a("dir/a.o"));
+    REQUIRE(a.config().pattern == "*.o");
+
+    SECTION("concurrent")
+    {
+        // Threads that compile the same pattern concurrently all end up with the Glob that was added first
+        const std::size_t pattern_count = 100;
+        std::vector<std::vector<const glob::Glob *>> results(4);
+        {
+            std::vector<std::jthread> threads;
+            for (auto &result : results)
+                threads.emplace_back([&]() {
+                    for (std::size_t ix = 0; ix < pattern_count; ++ix)
+                        result.push_back(&intern(W::All, "*." + std::to_string(ix), W::Nothing));
+                });
+        }
+        for (const auto &result : results)
+            REQUIRE(result == results[0]);
+        REQUIRE(intern.size() == 4 + pattern_count);
+    }
+}
@@ -0,0 +1,136 @@
+#include <rubr/glob/StaticGlob.hpp>
+#include <rubr/profile/Stopwatch.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace rubr;
+
+namespace {
+    // Paths that exercise anchoring, '/' handling and repeated literals
+    const std::vector<std::string> c_paths = {
+        "",
+        "a",
+        "abc",
+        "abcd",
+        "_abc",
+        "abc_",
+        "ab_c",
+        "a.cpp",
+        "a.hpp",
+        "a.cpp.o",
+        "dir/a.cpp",
+        "dir/sub/a.cpp",
+        "dir/a.hpp",
+        "/a.cpp",
+        "a/",
+        "a/b",
+        "a/bacb",
+        "acb",
+        "ab",
+        "build",
+        "build/",
+        "build/a.o",
+        "dir/build/a.o",
+        "node_modules/x/y",
+        "src/node_modules",
+    };
+
+    // Compares StaticGlob with Glob on the shared table and on random paths over a small alphabet
+    template<glob::FixedString Pattern, glob::Wildcard Front = glob::Wildcard::Nothing, glob::Wildcard Back = glob::Wildcard::Nothing>
+    void check()
+    {
+        const glob::Glob glob{glob::Glob::Config{.front = Front, .pattern = std::string(Pattern.view()), .back = Back}};
+        const glob::StaticGlob<Pattern, Front, Back> static_glob;
+
+        auto check_path = [&](const std::string &path) {
+            INFO(Pattern.view() << " " << (int)Front << " " << (int)Back << " " << path);
+            REQUIRE(static_glob(path) == glob(path));
+        };
+
+        for (const auto &path : c_paths)
+            check_path(path);
+
+        std::mt19937 rng{42};
+        const std::string alphabet{"abc/._"};
+        for (auto i = 0; i < 2000; ++i)
+        {
+            std::string path(rng() % 12, ' ');
+            for (auto &ch : path)
+                ch = alphabet[rng() % alphabet.size()];
+            check_path(path);
+        }
+    }
+} // namespace
+
+TEST_CASE("StaticGlob", "[ut][glob][StaticGlob]")
+{
+    SECTION("compile time")
+    {
+        static_assert(glob::StaticGlob<"*.cpp">{}("a.cpp"));
+        static_assert(!glob::StaticGlob<"*.cpp">{}("dir/a.cpp"));
+        static_assert(glob::StaticGlob<"**/*.cpp">{}("dir/sub/a.cpp"));
+        static_assert(!glob::StaticGlob<"**/*.cpp">{}("dir/sub/a.hpp"));
+        static_assert(glob::StaticGlob<"build", glob::Wildcard::All, glob::Wildcard::All>{}("dir/build/a.o"));
+    }
+
+    SECTION("same as Glob")
+    {
+        using W = glob::Wildcard;
+
+        check<"">();
+        check<"", W::All>();
+        check<"", W::Nothing, W::Some>();
+        check<"*">();
+        check<"**">();
+        check<"abc">();
+        check<"abc", W::All>();
+        check<"abc", W::Nothing, W::All>();
+        check<"*.cpp">();
+        check<"*.cpp", W::All>();
+        check<"**/*.cpp">();
+        check<"a*">();
+        check<"a**">();
+        check<"**abc**">();
+        check<"**a*b">();
+        check<"a*b*c">();
+        check<"a**b">();
+        check<"ab*b">();
+        check<"build/", W::All, W::All>();
+        check<"node_modules", W::All, W::All>();
+        check<"/a*.cpp">();
+        check<"a?c">();
+        check<"*.[ch]">();
+        check<"[!a]*", W::All>();
+        check<"[a-c]/[]b]?", W::Nothing, W::All>();
+        check<"a[*]b">();
+        check<"a[b">();
+        // Too long for the NFA, only the fast path is used
+        check<"*.this_is_a_very_long_extension_that_does_not_fit_in_the_nfa_of_a_glob">();
+    }
+}
+
+TEST_CASE("StaticGlob benchmark", "[.][bm][glob][StaticGlob]")
+{
+    const glob::Glob glob{glob::Glob::Config{.front = glob::Wildcard::All, .pattern = "*.cpp"}};
+    const glob::StaticGlob<"*.cpp", glob::Wildcard::All> static_glob;
+
+    const std::vector<std::string> paths = {"src/rubr/glob/Glob.cpp", "src/rubr/glob/Glob.hpp", "readme.md", "a/b/c/d/e/f/g.cpp"};
+    const auto n = 100000;
+    for (const auto &[name, use_static] : {std::pair{"Glob", false}, {"StaticGlob", true}})
+    {
+        profile::Stopwatch sw;
+        std::size_t count = 0;
+        for (auto i = 0; i < n; ++i)
+        {
+            for (const auto &path : paths)
+                count += use_static ? static_glob(path) : glob(path);
+        }
+        REQUIRE(count == 2 * n);
+        std::cout << name << ": " << sw.elapse<std::chrono::nanoseconds>().count() / n / paths.size() << "ns per path" << std::endl;
+    }
+}
@@ -0,0 +1,147 @@
+#include <rubr/parse/Columns.hpp>
+#include <rubr/parse/Strange.hpp>
+#include <rubr/profile/Stopwatch.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace rubr;
+
+namespace {
+    using Type = parse::Columns::Type;
+
+    // Rows of "<integer>;<float>;<anything>"
+    std::string generate(std::size_t row_count)
+    {
+        std::mt19937_64 rng{42};
+        std::string content;
+        for (std::size_t row = 0; row < row_count; ++row)
+        {
+            content += std::to_string((std::int64_t)rng() >> (rng() % 64)) + ';';
+            content += std::to_string((double)rng() / (1 << 20) - 1e12) + ';';
+            content += "text" + std::to_string(row);
+            content += row % 7 == 0 ? "\r\n" : "\n";
+        }
+        return content;
+    }
+} // namespace
+
+TEST_CASE("Columns", "[ut][parse][Columns]")
+{
+    SECTION("basic")
+    {
+        parse::Columns columns{{Type::Integer, Type::Skip, Type::Float}};
+        REQUIRE(columns.column_count() == 3);
+        REQUIRE(columns.parse("1,a,1.5\n-2,,-2e3\r\n\n3,c,inf"));
+        REQUIRE(columns.size() == 3);
+        REQUIRE(columns.integers(0) == std::vector<std::int64_t>{1, -2, 3});
+        REQUIRE(columns.floats(2) == std::vector<double>{1.5, -2e3, std::numeric_limits<double>::infinity()});
+        REQUIRE(columns.integers(1).empty());
+        REQUIRE(columns.floats(0).empty());
+
+        // Appends
+        REQUIRE(columns.parse("4,d,4\n"));
+        REQUIRE(columns.size() == 4);
+        REQUIRE(columns.integers(0).back() == 4);
+
+        columns.clear();
+        REQUIRE(columns.empty());
+        REQUIRE(columns.integers(0).empty());
+    }
+    SECTION("errors")
+    {
+        parse::Columns columns{{Type::Integer, Type::Float}};
+        REQUIRE(columns.parse("1,2\n"));
+        for (const auto &[content, offset] : {std::pair<std::string, std::size_t>{"1,2\n3", 5}, {"1,2\n3,4,5", 8}, {"1,2\nx,4", 4}, {"1,2\n3,4x", 6}, {"1,2\n 3,4", 4}, {"1,2\n3,", 6}, {"1,2\n99999999999999999999,4", 4}})
+        {
+            INFO(content);
+            REQUIRE(!columns.parse(content));
+            REQUIRE(columns.error_offset() == offset);
+            // Nothing is appended
+            REQUIRE(columns.size() == 1);
+            REQUIRE(columns.integers(0).size() == 1);
+            REQUIRE(columns.floats(1).size() == 1);
+        }
+    }
+    SECTION("same as Strange")
+    {
+        const auto content = generate(20000);
+
+        std::vector<std::int64_t> integers;
+        std::vector<double> floats;
+        parse::Strange strange{content};
+        for (parse::Strange line; strange.pop_line(line);)
+        {
+            long l;
+            double d;
+            REQUIRE(line.pop_decimal(l));
+            REQUIRE(line.pop_if(';'));
+            REQUIRE(line.pop_float(d));
+            integers.push_back(l);
+            floats.push_back(d);
+        }
+
+        for (const auto thread_count : {1u, 3u, 16u})
+        {
+            parse::Columns columns{{Type::Integer, Type::Float, Type::Skip}, {.delimiter = ';', .thread_count = thread_count}};
+            REQUIRE(columns.parse(content));
+            REQUIRE(columns.size() == integers.size());
+            REQUIRE(columns.integers(0) == integers);
+            REQUIRE(columns.floats(1) == floats);
+        }
+    }
+    SECTION("error in a chunk")
+    {
+        auto content = generate(20000);
+        const auto offset = content.size() * 2 / 3;
+        content[offset] = 'x';
+
+        for (const auto thread_count : {1u, 4u})
+        {
+            parse::Columns columns{{Type::Integer, Type::Float, Type::Skip}, {.delimiter = ';', .thread_count = thread_count}};
+            REQUIRE(!columns.parse(content));
+            REQUIRE(columns.error_offset() <= offset);
+            REQUIRE(content.find('\n', columns.error_offset()) >= offset);
+            REQUIRE(columns.empty());
+        }
+    }
+}
+
+TEST_CASE("Columns benchmark", "[.][bm][parse][Columns]")
+{
+    const auto content = generate(1000000);
+
+    {
+        profile::Stopwatch sw;
+        std::vector<std::int64_t> integers;
+        std::vector<double> floats;
+        parse::Strange strange{content};
+        for (parse::Strange line; strange.pop_line(line);)
+        {
+            long l;
+            double d;
+            line.each_split(';', [&](parse::Strange &field) {
+                if (field.pop_decimal(l) && field.empty())
+                    integers.push_back(l);
+                else if (field.pop_float(d) && field.empty())
+                    floats.push_back(d);
+            });
+        }
+        REQUIRE(integers.size() == 1000000);
+        std::cout << "each_split: " << sw.elapse<std::chrono::milliseconds>().count() << "ms" << std::endl;
+    }
+
+    for (const auto thread_count : {1u, 0u})
+    {
+        profile::Stopwatch sw;
+        parse::Columns columns{{Type::Integer, Type::Float, Type::Skip}, {.delimiter = ';', .thread_count = thread_count}};
+        REQUIRE(columns.parse(content));
+        REQUIRE(columns.size() == 1000000);
+        std::cout << "Columns with " << thread_count << " threads: " << sw.elapse<std::chrono::milliseconds>().count() << "ms" << std::endl;
+    }
+}
@@ -0,0 +1,155 @@
+#include <rubr/parse/Lines.hpp>
+#include <rubr/parse/Strange.hpp>
+#include <rubr/profile/Stopwatch.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace rubr;
+
+namespace {
+    std::vector<std::string> split(const std::string &content)
+    {
+        parse::Lines lines;
+        lines.scan(content);
+        std::vector<std::string> res;
+        for (const auto line : lines)
+            res.emplace_back(line);
+        return res;
+    }
+} // namespace
+
+TEST_CASE("Lines", "[ut][parse][Lines]")
+{
+    using Exp = std::vector<std::string>;
+
+    SECTION("empty")
+    {
+        parse::Lines lines;
+        REQUIRE(lines.empty());
+        lines.scan("");
+        REQUIRE(lines.empty());
+        REQUIRE(lines.start(0) == 0);
+    }
+    SECTION("endings")
+    {
+        REQUIRE(split("a") == Exp{"a"});
+        REQUIRE(split("a\n") == Exp{"a"});
+        REQUIRE(split("a\n\n") == Exp{"a", ""});
+        REQUIRE(split("\n") == Exp{""});
+        REQUIRE(split("a\r\nb\rc\nd") == Exp{"a", "b", "c", "d"});
+        REQUIRE(split("a\r\r\nb\r") == Exp{"a", "", "b"});
+        REQUIRE(split("\r\n\r\n") == Exp{"", ""});
+        REQUIRE(split("a\n\rb") == Exp{"a", "", "b"});
+    }
+    SECTION("reuse")
+    {
+        parse::Lines lines;
+        lines.scan("a\nb\nc\n");
+        REQUIRE(lines.size() == 3);
+        lines.scan("d");
+        REQUIRE(lines.size() == 1);
+        REQUIRE(lines[0] == "d");
+        REQUIRE(lines.start(0) == 0);
+        REQUIRE(lines.start(1) == 1);
+    }
+    SECTION("lone carriage return")
+    {
+        // Straightforward reference, on inputs that cross the SIMD steps
+        auto reference = [](const std::string &content) {
+            Exp res;
+            std::string line;
+            for (std::size_t ix = 0; ix < content.size(); ++ix)
+            {
+                const auto ch = content[ix];
+                if (ch == '\n' || ch == '\r')
+                {
+                    if (ch == '\r' && ix + 1 < content.size() && content[ix + 1] == '\n')
+                        ++ix;
+                    res.push_back(line);
+                    line.clear();
+                }
+                else
+                    line += ch;
+            }
+            if (!line.empty())
+                res.push_back(line);
+            return res;
+        };
+
+        std::mt19937 rng{42};
+        const std::string alphabet = "ab\n\r";
+        for (auto i = 0; i < 1000; ++i)
+        {
+            std::string content(rng() % 300, ' ');
+            for (auto &ch : content)
+                ch = alphabet[rng() % alphabet.size()];
+            REQUIRE(split(content) == reference(content));
+        }
+    }
+    SECTION("same as pop_line")
+    {
+        // pop_line() only treats a lone '\r' as end-of-line when no '\n' follows, which these inputs avoid
+        std::mt19937 rng{42};
+        const std::vector<std::string> tokens = {"a", "b", "\n", "\r\n", " "};
+        for (auto i = 0; i < 1000; ++i)
+        {
+            std::string content;
+            for (auto n = rng() % 100; n > 0; --n)
+                content += tokens[rng() % tokens.size()];
+
+            Exp exp;
+            parse::Strange strange{content};
+            for (std::string line; strange.pop_line(line);)
+                exp.push_back(line);
+            REQUIRE(split(content) == exp);
+        }
+    }
+}
+
+TEST_CASE("Lines benchmark", "[.][bm][parse][Lines]")
+{
+    // A chunk of a log with lines of varying length, as read from a large file
+    std::string content;
+    std::mt19937 rng{42};
+    while (content.size() < 1024 * 1024)
+    {
+        content.append(20 + rng() % 100, 'x');
+        content += '\n';
+    }
+
+    const auto n = 100;
+    parse::Lines lines;
+    for (const auto &[name, use_lines] : {std::pair{"pop_line", false}, {"Lines", true}})
+    {
+        profile::Stopwatch sw;
+        std::size_t count = 0, total = 0;
+        for (auto i = 0; i < n; ++i)
+        {
+            if (use_lines)
+            {
+                lines.scan(content);
+                for (const auto line : lines)
+                {
+                    ++count;
+                    total += line.size();
+                }
+            }
+            else
+            {
+                parse::Strange strange{content};
+                for (parse::Strange line; strange.pop_line(line);)
+                {
+                    ++count;
+                    total += line.size();
+                }
+            }
+        }
+        REQUIRE(total + count == n * content.size());
+        std::cout << name << ": " << sw.elapse<std::chrono::microseconds>().count() / n << "us per MB" << std::endl;
+    }
+}
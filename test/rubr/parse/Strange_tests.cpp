@@ -0,0 +1,339 @@
+#include <rubr/parse/Strange.hpp>
+#include <rubr/profile/Stopwatch.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace rubr;
+
+TEST_CASE("position", "[ut][parse][Strange][position]")
+{
+    const std::string content = "ab\ncd\n\nefg\r\nh";
+
+    auto check = [&](bool use_index) {
+        parse::Strange strange{content};
+        if (use_index)
+            strange.enable_line_index();
+
+        REQUIRE(strange.position().line == 0);
+
+        parse::Strange line;
+        REQUIRE(strange.pop_line(line));
+        REQUIRE(strange.pop_line(line));
+        REQUIRE(line.str() == "cd");
+        // Views that were popped refer to the same buffer
+        REQUIRE(line.position().ix == 3);
+        REQUIRE(line.position().line == 1);
+        REQUIRE(line.position().column == 0);
+
+        REQUIRE(strange.pop_line(line));
+        REQUIRE(strange.pop_to(line, 'g'));
+        REQUIRE(strange.position().ix == 9);
+        REQUIRE(strange.position().line == 3);
+        REQUIRE(strange.position().column == 2);
+
+        // Backwards
+        REQUIRE(line.position().line == 3);
+        REQUIRE(line.position().column == 0);
+
+        strange.pop_all(line);
+        REQUIRE(line.position().line == 3);
+        REQUIRE(line.position().column == 2);
+    };
+
+    SECTION("counting") { check(false); }
+    SECTION("index") { check(true); }
+    SECTION("random")
+    {
+        std::mt19937 rng{42};
+        std::string str(1000, ' ');
+        for (auto &ch : str)
+            ch = "ab\n\r"[rng() % 4];
+
+        parse::Strange plain{str};
+        parse::Strange indexed{str};
+        indexed.enable_line_index();
+        for (auto i = 0; i < 1000; ++i)
+        {
+            // Mostly small steps forward, sometimes a jump back
+            const auto nr = rng() % 8 == 0 ? 0 : rng() % 20;
+            if (nr == 0)
+            {
+                plain = parse::Strange{str};
+                indexed = parse::Strange{str};
+                indexed.enable_line_index();
+                const auto ix = rng() % str.size();
+                plain.pop_count(ix);
+                indexed.pop_count(ix);
+            }
+            else
+            {
+                plain.pop_count(std::min<std::size_t>(nr, plain.size()));
+                indexed.pop_count(std::min<std::size_t>(nr, indexed.size()));
+            }
+            const auto exp = plain.position();
+            const auto pos = indexed.position();
+            REQUIRE(pos.ix == exp.ix);
+            REQUIRE(pos.line == exp.line);
+            REQUIRE(pos.column == exp.column);
+        }
+    }
+}
+
+TEST_CASE("position benchmark", "[.][bm][parse][Strange][position]")
+{
+    // A position for each line of a large input, as when each line produces a diagnostic
+    std::string content;
+    for (auto i = 0; i < 20000; ++i)
+        content += "line " + std::to_string(i) + " with some content\n";
+
+    for (const auto &[name, use_index] : {std::pair{"counting", false}, {"index", true}})
+    {
+        parse::Strange strange{content};
+        if (use_index)
+            strange.enable_line_index();
+
+        profile::Stopwatch sw;
+        std::size_t count = 0;
+        for (parse::Strange line; strange.pop_line(line);)
+            count += line.position().line;
+        REQUIRE(count == 20000ull * 19999 / 2);
+        std::cout << name << ": " << sw.elapse<std::chrono::microseconds>().count() << "us" << std::endl;
+    }
+}
+
+TEST_CASE("pop_float", "[ut][parse][Strange][pop_float]")
+{
+    SECTION("same as strtod")
+    {
+        for (const std::string str : {"1.5", " 1.5", "\t\n\v\f\r 1.5", "+2", "-0", ".5", "5.", "1e3", "1e", "1e+", "1.5e-3x", "1e400", "-1e400", "1e-400", "-1e-400", "0.0000001e-320", "1000000000000000000000e300", "123456789012345678901234567890", "inf", "-infinity", "nan", "4.9e-324", "1.7976931348623157e308"})
+        {
+            INFO(str);
+            char *e = nullptr;
+            const double exp = std::strtod(str.c_str(), &e);
+
+            parse::Strange strange{str};
+            double d = -1;
+            REQUIRE(strange.pop_float(d));
+            REQUIRE(strange.size() == str.size() - (e - str.c_str()));
+            if (std::isnan(exp))
+                REQUIRE(std::isnan(d));
+            else
+                REQUIRE(std::bit_cast<std::uint64_t>(d) == std::bit_cast<std::uint64_t>(exp));
+        }
+    }
+    SECTION("invalid")
+    {
+        for (const std::string str : {"", "abc", "+-1", "-", ".", "e3", " ", " \t", "\xa0" "1"})
+        {
+            INFO(str);
+            parse::Strange strange{str};
+            double d = -1;
+            REQUIRE(!strange.pop_float(d));
+            REQUIRE(d == -1);
+            REQUIRE(strange.size() == str.size());
+        }
+    }
+    SECTION("bounded")
+    {
+        // strtod() would read beyond the end of the Strange
+        const std::string str = "1.25e3";
+        parse::Strange strange{str.data(), 3};
+        double d;
+        REQUIRE(strange.pop_float(d));
+        REQUIRE(d == 1.2);
+        REQUIRE(strange.empty());
+
+        parse::Strange strange2{str.data(), 5};
+        float f;
+        REQUIRE(strange2.pop_float(f));
+        REQUIRE(f == 1.25f);
+        REQUIRE(strange2.size() == 1);
+    }
+    SECTION("round trip")
+    {
+        std::mt19937_64 rng{42};
+        char buffer[64];
+        for (auto i = 0; i < 10000; ++i)
+        {
+            const auto d = std::bit_cast<double>(rng());
+            const auto f = std::bit_cast<float>((std::uint32_t)rng());
+            for (const auto format : {std::chars_format::general, std::chars_format::scientific})
+            {
+                if (std::isfinite(d))
+                {
+                    const auto end = std::to_chars(buffer, buffer + sizeof(buffer), d, format).ptr;
+                    parse::Strange strange{buffer, std::size_t(end - buffer)};
+                    double res;
+                    REQUIRE(strange.pop_float(res));
+                    REQUIRE(strange.empty());
+                    REQUIRE(std::bit_cast<std::uint64_t>(res) == std::bit_cast<std::uint64_t>(d));
+                }
+                if (std::isfinite(f))
+                {
+                    const auto end = std::to_chars(buffer, buffer + sizeof(buffer), f, format).ptr;
+                    parse::Strange strange{buffer, std::size_t(end - buffer)};
+                    float res;
+                    REQUIRE(strange.pop_float(res));
+                    REQUIRE(strange.empty());
+                    REQUIRE(std::bit_cast<std::uint32_t>(res) == std::bit_cast<std::uint32_t>(f));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("pop_float benchmark", "[.][bm][parse][Strange][pop_float]")
+{
+    // Telemetry-like values, separated by ','
+    std::mt19937_64 rng{42};
+    std::uniform_real_distribution<double> dist{-1000.0, 1000.0};
+    std::string content;
+    const auto count = 1000000;
+    char buffer[64];
+    for (auto i = 0; i < count; ++i)
+    {
+        content.append(buffer, std::snprintf(buffer, sizeof(buffer), "%.6f", dist(rng)));
+        content += ',';
+    }
+
+    for (const auto &[name, use_strtod] : {std::pair{"strtod", true}, {"pop_float", false}})
+    {
+        profile::Stopwatch sw;
+        double sum = 0;
+        if (use_strtod)
+        {
+            for (const char *ptr = content.c_str(); *ptr; ++ptr)
+            {
+                char *end;
+                sum += std::strtod(ptr, &end);
+                ptr = end;
+            }
+        }
+        else
+        {
+            parse::Strange strange{content};
+            for (double d; strange.pop_float(d); strange.pop_if(','))
+                sum += d;
+        }
+        REQUIRE(std::abs(sum) < count * 1000.0);
+        std::cout << name << ": " << sw.elapse<std::chrono::nanoseconds>().count() / count << "ns per value" << std::endl;
+    }
+}
+
+TEST_CASE("pop_to needle", "[ut][parse][Strange][Needle]")
+{
+    SECTION("random")
+    {
+        // Small alphabet to get many partial matches
+        std::mt19937 rng{42};
+        auto random_str = [&](std::size_t size) {
+            std::string str(size, ' ');
+            for (auto &ch : str)
+                ch = "ab<"[rng() % 3];
+            return str;
+        };
+        for (auto i = 0; i < 20000; ++i)
+        {
+            const auto needle_str = random_str(1 + rng() % 5);
+            const auto content = random_str(rng() % 100);
+            const auto exp = std::string_view{content}.find(needle_str);
+            const bool inclusive = rng() % 2;
+
+            parse::Strange strange{content};
+            parse::Strange res;
+            REQUIRE(strange.pop_to(res, needle_str) == (exp != std::string::npos));
+            if (exp != std::string::npos)
+            {
+                REQUIRE(res.size() == exp);
+                REQUIRE(strange.size() == content.size() - exp);
+            }
+            else
+                REQUIRE(strange.size() == content.size());
+
+            strange = parse::Strange{content};
+            REQUIRE(strange.pop_until(res, strng::Needle{needle_str}, inclusive) == (exp != std::string::npos));
+            if (exp != std::string::npos)
+            {
+                REQUIRE(res.size() == exp + (inclusive ? needle_str.size() : 0));
+                REQUIRE(strange.size() == content.size() - exp - needle_str.size());
+            }
+        }
+    }
+    SECTION("reuse")
+    {
+        const std::string content = "<p>One</P><p>Two</p>";
+        const strng::Needle close{"</p>", true};
+        parse::Strange strange{content};
+        std::vector<std::string> texts;
+        for (parse::Strange text; strange.pop_if("<p>") && strange.pop_until(text, close);)
+            texts.push_back(text.str());
+        REQUIRE(texts == std::vector<std::string>{"One", "Two"});
+        REQUIRE(strange.empty());
+
+        // An empty needle never matches for pop_to() and matches immediately for pop_until()
+        parse::Strange res;
+        strange = parse::Strange{content};
+        REQUIRE(!strange.pop_to(res, strng::Needle{}));
+        REQUIRE(strange.pop_until(res, strng::Needle{}));
+        REQUIRE(strange.size() == content.size());
+    }
+}
+
+TEST_CASE("pop_to needle benchmark", "[.][bm][parse][Strange][Needle]")
+{
+    // Markup where the first byte of the needle is frequent
+    std::string content;
+    for (auto i = 0; i < 2000; ++i)
+    {
+        for (auto j = 0; j < 50; ++j)
+            content += "<b>x</b> ";
+        content += "</section>";
+    }
+
+    // The memchr() and memcmp() search that pop_to() used before
+    auto pop_to_memchr = [](parse::Strange &strange, parse::Strange &res, const std::string &str) {
+        const auto view = strange.view();
+        for (const char *ptr = view.data(); (ptr = (const char *)std::memchr(ptr, str[0], view.data() + view.size() - ptr));)
+        {
+            const std::size_t ix = ptr - view.data();
+            if (view.size() - ix < str.size())
+                break;
+            if (std::memcmp(ptr, str.data(), str.size()) == 0)
+                return strange.pop_count(res, ix);
+            ++ptr;
+        }
+        return false;
+    };
+
+    const std::string str = "</section>";
+    const strng::Needle needle{str};
+    const auto n = 10;
+    for (const auto &[name, method] : {std::pair{"memchr", 0}, {"std::string", 1}, {"Needle", 2}})
+    {
+        profile::Stopwatch sw;
+        std::size_t count = 0;
+        for (auto i = 0; i < n; ++i)
+        {
+            parse::Strange strange{content};
+            for (parse::Strange res;; strange.pop_count(str.size()), ++count)
+            {
+                const bool ok = method == 0 ? pop_to_memchr(strange, res, str) : method == 1 ? strange.pop_to(res, str) : strange.pop_to(res, needle);
+                if (!ok)
+                    break;
+            }
+        }
+        REQUIRE(count == n * 2000);
+        std::cout << name << ": " << sw.elapse<std::chrono::microseconds>().count() / n << "us" << std::endl;
+    }
+}
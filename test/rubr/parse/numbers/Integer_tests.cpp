@@ -0,0 +1,200 @@
+#include <rubr/parse/Strange.hpp>
+#include <rubr/parse/numbers/Integer.hpp>
+#include <rubr/profile/Stopwatch.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace rubr;
+
+namespace {
+    // Reads with read() and std::from_chars(), which must agree on the value and the number of chars used
+    template<typename T>
+    void check(const std::string &str, bool hex = false)
+    {
+        INFO(str);
+        T exp{};
+        const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), exp, hex ? 16 : 10);
+
+        T v{};
+        std::size_t len = str.size();
+        const auto ok = hex ? parse::numbers::read_hex(v, str.data(), len) : parse::numbers::read(v, str.data(), len);
+        REQUIRE(ok == (ec == std::errc{}));
+        if (ok)
+        {
+            REQUIRE(v == exp);
+            REQUIRE(len == std::size_t(ptr - str.data()));
+        }
+        else
+            REQUIRE(len == str.size());
+    }
+
+    template<typename T>
+    void check_all(const std::string &str)
+    {
+        check<T>(str);
+        check<T>(str, true);
+    }
+
+    // The lookup table implementation that read() used before, as reference for the benchmark
+    bool read_with_tables(long &l, const char *buf, std::size_t &len)
+    {
+        static const auto tables = []() {
+            std::vector<std::array<unsigned long, 10>> res(19);
+            unsigned long m = 1;
+            for (auto &table : res)
+            {
+                for (auto d = 0u; d < 10; ++d)
+                    table[d] = m * d;
+                m *= 10;
+            }
+            return res;
+        }();
+
+        std::size_t s = 0;
+        const bool is_negative = *buf == '-';
+        if (is_negative)
+            ++s;
+        std::size_t n = 0;
+        for (; s + n < len && buf[s + n] >= '0' && buf[s + n] <= '9'; ++n) {}
+        if (n == 0 || n > tables.size())
+            return false;
+        unsigned long v = 0;
+        for (auto i = 0u; i < n; ++i)
+            v += tables[n - 1 - i][buf[s + i] - '0'];
+        l = is_negative ? -(long)v : (long)v;
+        len = s + n;
+        return true;
+    }
+} // namespace
+
+TEST_CASE("numbers::read", "[ut][parse][numbers][Integer]")
+{
+    SECTION("fixed")
+    {
+        for (const std::string str : {"", "-", "a", "0", "-0", "1", "-1", "12a", "0012", "9-", "127", "128", "-128", "-129", "255", "256", "65535", "65536", "-32768", "2147483647", "2147483648", "-2147483648", "-2147483649", "4294967295", "4294967296",
+                                      "9223372036854775807", "9223372036854775808", "-9223372036854775808", "-9223372036854775809", "18446744073709551615", "18446744073709551616", "99999999999999999999", "000000000000000000000000000000001",
+                                      "ff", "FFFF", "7fffffffffffffff", "8000000000000000", "ffffffffffffffff", "10000000000000000", "0000000000000000000fffffffffffffffff", "aBcDeFg", "0x12", "12345678 ", "1234567890123456789012345", "@`/:GgFf"})
+        {
+            check_all<std::int8_t>(str);
+            check_all<std::uint8_t>(str);
+            check_all<std::int16_t>(str);
+            check_all<std::uint16_t>(str);
+            check_all<int>(str);
+            check_all<unsigned int>(str);
+            check_all<long>(str);
+            check_all<std::int64_t>(str);
+            check_all<std::uint64_t>(str);
+        }
+    }
+    SECTION("random")
+    {
+        // Digit runs of all lengths, at all offsets in the SIMD and SWAR steps, followed by all kinds of chars
+        std::mt19937_64 rng{42};
+        const std::string chars = "0123456789abcdefABCDEF-+ xX/:@G`g";
+        for (auto i = 0; i < 100000; ++i)
+        {
+            std::string str;
+            if (rng() % 2)
+                str += '-';
+            const auto zeros = rng() % 4 == 0 ? rng() % 20 : 0;
+            str.append(zeros, '0');
+            for (auto n = rng() % 25; n > 0; --n)
+                str += chars[rng() % (rng() % 2 ? 10 : 22)];
+            for (auto n = rng() % 20; n > 0; --n)
+                str += chars[rng() % chars.size()];
+
+            check_all<std::int32_t>(str);
+            check_all<std::uint32_t>(str);
+            check_all<std::int64_t>(str);
+            check_all<std::uint64_t>(str);
+        }
+    }
+    SECTION("bounded")
+    {
+        // Only the first len chars are used
+        const std::string str = "12345678901234567890123";
+        for (std::size_t size = 0; size <= str.size(); ++size)
+        {
+            std::uint64_t v = 0;
+            std::size_t len = size;
+            REQUIRE(parse::numbers::read(v, str.data(), len) == (size > 0 && size <= 20));
+            if (size > 0 && size <= 20)
+            {
+                REQUIRE(len == size);
+                REQUIRE(std::to_string(v) == str.substr(0, size));
+            }
+        }
+    }
+    SECTION("Strange")
+    {
+        const std::string str = "-12,300000,ff,-1,";
+        parse::Strange strange{str};
+        long l;
+        REQUIRE(strange.pop_decimal(l));
+        REQUIRE(l == -12);
+        REQUIRE(strange.pop_if(','));
+
+        std::uint16_t u16;
+        REQUIRE(!strange.pop_decimal(u16));
+        std::uint32_t u32;
+        REQUIRE(strange.pop_decimal(u32));
+        REQUIRE(u32 == 300000);
+        REQUIRE(strange.pop_if(','));
+
+        REQUIRE(!strange.pop_decimal(u32));
+        REQUIRE(strange.pop_hex(u32));
+        REQUIRE(u32 == 255);
+        REQUIRE(strange.pop_if(','));
+
+        REQUIRE(!strange.pop_decimal(u32));
+        int i;
+        REQUIRE(strange.pop_decimal(i));
+        REQUIRE(i == -1);
+        REQUIRE(strange.str() == ",");
+    }
+}
+
+TEST_CASE("numbers::read benchmark", "[.][bm][parse][numbers][Integer]")
+{
+    // Short and long values, as in a CSV with counters and timestamps
+    std::mt19937_64 rng{42};
+    std::string content;
+    const auto count = 1000000;
+    for (auto i = 0; i < count; ++i)
+    {
+        const auto v = rng() >> (1 + rng() % 63);
+        content += (i % 2 ? std::to_string(v) : std::to_string(v % 10000)) + ',';
+    }
+
+    const std::vector<std::pair<const char *, int>> methods = {{"tables", 0}, {"read", 1}, {"from_chars", 2}};
+    for (const auto &[name, method] : methods)
+    {
+        profile::Stopwatch sw;
+        std::uint64_t sum = 0;
+        const char *ptr = content.data();
+        const char *end = ptr + content.size();
+        for (; ptr < end; ++ptr)
+        {
+            long l = 0;
+            std::size_t len = end - ptr;
+            switch (method)
+            {
+                case 0: read_with_tables(l, ptr, len); break;
+                case 1: parse::numbers::read(l, ptr, len); break;
+                case 2: len = std::from_chars(ptr, end, l).ptr - ptr; break;
+            }
+            sum += l;
+            ptr += len;
+        }
+        REQUIRE(sum != 0);
+        std::cout << name << ": " << sw.elapse<std::chrono::nanoseconds>().count() * 1000 / count << "ps per value" << std::endl;
+    }
+}
@@ -0,0 +1,109 @@
+#include <rubr/parse/Strange.hpp>
+#include <rubr/profile/Stopwatch.hpp>
+#include <rubr/strng/CharSet.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace rubr;
+
+TEST_CASE("CharSet", "[ut][strng][CharSet]")
+{
+    SECTION("edge cases")
+    {
+        const strng::CharSet empty;
+        REQUIRE(empty.find("abc") == strng::CharSet::npos);
+        REQUIRE(empty.find_not("abc") == 0);
+        REQUIRE(empty.rfind_not("abc") == 2);
+
+        const strng::CharSet set{"a\x80\xff"};
+        REQUIRE(set.contains('a'));
+        REQUIRE(set.contains('\x80'));
+        REQUIRE(set.contains('\xff'));
+        REQUIRE(!set.contains('\x7f'));
+        REQUIRE(!set.contains('\x01'));
+        REQUIRE(!set.contains('q'));
+        REQUIRE(set.find("") == strng::CharSet::npos);
+        REQUIRE(set.find("bca", 3) == strng::CharSet::npos);
+        REQUIRE(set.find("bca", 4) == strng::CharSet::npos);
+        REQUIRE(set.rfind_not("") == strng::CharSet::npos);
+        REQUIRE(set.rfind_not("aa") == strng::CharSet::npos);
+    }
+    SECTION("random")
+    {
+        // All bytes, and inputs around the SIMD block sizes
+        std::mt19937 rng{42};
+        for (auto i = 0; i < 20000; ++i)
+        {
+            std::string chars(rng() % 8, ' ');
+            for (auto &ch : chars)
+                ch = (char)rng();
+            const strng::CharSet set{chars};
+
+            // Mostly bytes from the set, to get long runs for find_not()
+            std::string str(rng() % 100, ' ');
+            for (auto &ch : str)
+                ch = !chars.empty() && rng() % 8 ? chars[rng() % chars.size()] : (char)rng();
+            const std::string_view sv{str};
+            const auto pos = rng() % 102;
+
+            REQUIRE(set.find(sv, pos) == sv.find_first_of(chars, pos));
+            REQUIRE(set.find_not(sv, pos) == sv.find_first_not_of(chars, pos));
+            REQUIRE(set.rfind_not(sv) == sv.find_last_not_of(chars));
+        }
+    }
+    SECTION("Strange")
+    {
+        const std::string content = "  \tkey = value;\t ";
+        const strng::CharSet whitespace{" \t"};
+        parse::Strange strange{content};
+        REQUIRE(strange.strip_left(whitespace) == 3);
+        REQUIRE(strange.strip_right(whitespace) == 2);
+
+        parse::Strange key;
+        REQUIRE(strange.pop_to_any(key, strng::CharSet{"=;"}));
+        REQUIRE(key.str() == "key ");
+        REQUIRE(strange.pop_until_any(key, strng::CharSet{"=;"}));
+        REQUIRE(key.empty());
+        REQUIRE(strange.pop_until_any(key, strng::CharSet{"=;"}, true));
+        REQUIRE(key.str() == " value;");
+        REQUIRE(!strange.pop_to_any(key, whitespace));
+        REQUIRE(strange.empty());
+
+        parse::Strange blank{content.data(), 2};
+        REQUIRE(blank.strip_right(whitespace) == 2);
+        REQUIRE(blank.empty());
+    }
+}
+
+TEST_CASE("CharSet benchmark", "[.][bm][strng][CharSet]")
+{
+    // Tokenizing source text on operators and whitespace
+    std::string content;
+    std::mt19937 rng{42};
+    while (content.size() < 1024 * 1024)
+    {
+        content.append(1 + rng() % 20, 'a' + rng() % 26);
+        content += " (){}<>;,=+-*/&|!"[rng() % 17];
+    }
+    const std::string separators = " \t\n(){}[]<>;,.=+-*/&|!?:";
+    const strng::CharSet set{separators};
+
+    const auto n = 10;
+    for (const auto &[name, use_set] : {std::pair{"std::string", false}, {"CharSet", true}})
+    {
+        profile::Stopwatch sw;
+        std::size_t count = 0;
+        for (auto i = 0; i < n; ++i)
+        {
+            parse::Strange strange{content};
+            for (parse::Strange token; use_set ? strange.pop_until_any(token, set) : strange.pop_until_any(token, separators);)
+                count += token.size() + 1;
+        }
+        REQUIRE(count == n * content.size());
+        std::cout << name << ": " << sw.elapse<std::chrono::microseconds>().count() / n << "us per MB" << std::endl;
+    }
+}
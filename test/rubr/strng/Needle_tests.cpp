@@ -0,0 +1,94 @@
+#include <rubr/profile/Stopwatch.hpp>
+#include <rubr/strng/Needle.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace rubr;
+
+TEST_CASE("Needle", "[ut][strng][Needle]")
+{
+    SECTION("edge cases")
+    {
+        REQUIRE(strng::Needle{""}.find("abc") == 0);
+        REQUIRE(strng::Needle{""}.find("abc", 3) == 3);
+        REQUIRE(strng::Needle{""}.find("abc", 4) == strng::Needle::npos);
+        REQUIRE(strng::Needle{"abc"}.find("ab") == strng::Needle::npos);
+        REQUIRE(strng::Needle{"abc"}.find("abc") == 0);
+        REQUIRE(strng::Needle{"abc"}.find("abcabc", 1) == 3);
+    }
+    SECTION("random")
+    {
+        // Small alphabet and haystacks around the SIMD block sizes to exercise candidates, tails and boundaries
+        std::mt19937 rng{42};
+        auto random_str = [&](std::size_t size) {
+            std::string str(size, ' ');
+            for (auto &ch : str)
+                ch = "ab/"[rng() % 3];
+            return str;
+        };
+        for (auto i = 0; i < 20000; ++i)
+        {
+            const auto needle_str = random_str(rng() % 6);
+            const auto haystack = random_str(rng() % 80);
+            const auto pos = rng() % 82;
+            const strng::Needle needle{needle_str};
+            REQUIRE(needle.find(haystack, pos) == std::string_view{haystack}.find(needle_str, pos));
+        }
+    }
+    SECTION("ignore case")
+    {
+        REQUIRE(strng::Needle{"ReadMe", true}.find("x/README.md") == 2);
+        REQUIRE(strng::Needle{"a", true}.find("bA") == 1);
+        // Setting bit 0x20 must not make '@' match '`'
+        REQUIRE(strng::Needle{"`a", true}.find("@A") == strng::Needle::npos);
+
+        std::mt19937 rng{42};
+        auto random_str = [&](std::size_t size) {
+            std::string str(size, ' ');
+            for (auto &ch : str)
+                ch = "aAb@`/"[rng() % 6];
+            return str;
+        };
+        auto to_lower = [](std::string str) {
+            for (auto &ch : str)
+                ch = (ch >= 'A' && ch <= 'Z') ? ch + 'a' - 'A' : ch;
+            return str;
+        };
+        for (auto i = 0; i < 20000; ++i)
+        {
+            const auto needle_str = random_str(rng() % 6);
+            const auto haystack = random_str(rng() % 80);
+            const auto pos = rng() % 82;
+            const strng::Needle needle{needle_str, true};
+            REQUIRE(needle.find(haystack, pos) == std::string_view{to_lower(haystack)}.find(to_lower(needle_str), pos));
+        }
+    }
+}
+
+TEST_CASE("Needle benchmark", "[.][bm][strng][Needle]")
+{
+    // A frequent first byte makes std::string_view::find() verify many candidates
+    std::string haystack;
+    for (auto i = 0; i < 100000; ++i)
+        haystack += "/a/b/c/d";
+    haystack += "/build/";
+
+    for (const auto &needle_str : {"/build/", "node_modules", ".o"})
+    {
+        const strng::Needle needle{needle_str};
+        const auto n = 100;
+        for (const auto &[name, use_needle] : {std::pair{"string_view::find", false}, {"Needle::find", true}})
+        {
+            profile::Stopwatch sw;
+            std::size_t sum = 0;
+            for (auto i = 0; i < n; ++i)
+                sum += use_needle ? needle.find(haystack) : std::string_view{haystack}.find(needle_str);
+            REQUIRE(sum > 0);
+            std::cout << needle_str << " " << name << ": " << sw.elapse<std::chrono::microseconds>().count() / n << "us" << std::endl;
+        }
+    }
+}